@@ -13,19 +13,24 @@
 
 // Standard C includes
 #include <cmath>
+#include <cstdlib>
 
 // OpenCV includes
 #include <opencv2/opencv.hpp>
 
-// OpenGL includes
-#include <GL/glew.h>
-#include <GL/glu.h>
+#ifndef HEADLESS
+    // OpenGL includes
+    #include <GL/glew.h>
+    #include <GL/glu.h>
 
-// GLFW
-#include <GLFW/glfw3.h>
+    // GLFW
+    #include <GLFW/glfw3.h>
+
+    // CUDA includes
+    #include <cuda_gl_interop.h>
+#endif
 
 // CUDA includes
-#include <cuda_gl_interop.h>
 #include <cuda_runtime.h>
 
 // GeNN includes
@@ -42,22 +47,36 @@
 // Antworld includes
 #include "common.h"
 #include "parameters.h"
-#include "render_mesh.h"
 #include "route.h"
 #include "snapshot_processor.h"
-#include "world.h"
+
+#ifndef HEADLESS
+    #include "render_mesh.h"
+    #include "world.h"
+#endif
+
+#ifdef SOFTWARE_RENDERER
+    #include "software_renderer.h"
+#endif
+
+#ifdef SNAPSHOT_CACHE
+    #include "snapshot_cache.h"
+#endif
+
+// **NOTE** without a window, snapshots have to be rendered on the CPU or looked up in a cache
+#if defined(HEADLESS) && !defined(SOFTWARE_RENDERER) && !defined(SNAPSHOT_CACHE)
+    #error "HEADLESS requires SOFTWARE_RENDERER or SNAPSHOT_CACHE"
+#endif
+
+#if defined(HEADLESS) && defined(BATCH_SCAN) && !defined(SOFTWARE_RENDERER)
+    #error "HEADLESS BATCH_SCAN requires SOFTWARE_RENDERER to render panoramas"
+#endif
 
 //----------------------------------------------------------------------------
 // Anonymous namespace
 //----------------------------------------------------------------------------
 namespace
 {
-// What colour should the ground be?
-constexpr GLfloat groundColour[] = {0.898f, 0.718f, 0.353f};
-
-// What colour should the brightest tussocks be?
-constexpr GLfloat worldColour[] = {0.0f, 1.0f, 0.0f};
-
 // How fast does the ant move?
 constexpr float antTurnSpeed = 4.0f;
 constexpr float antMoveSpeed = 0.05f;
@@ -66,8 +85,15 @@ constexpr float antMoveSpeed = 0.05f;
 constexpr int displayRenderWidth = 640;
 constexpr int displayRenderHeight = 178;
 
-constexpr int intermediateSnapshotWidth = 74;
-constexpr int intermediateSnapshowHeight = 19;
+#ifdef BATCH_SCAN
+// Width of full 360 degree panorama rendered once per test position
+// **NOTE** scan headings are extracted by rotating this so each scan step must be a whole number of columns
+constexpr int panoramaWidth = 360;
+constexpr int panoramaViewWidth = (int)(antViewHorizontalFOV * (float)panoramaWidth / 360.0f);
+constexpr int panoramaColumnsPerScanStep = (int)(Parameters::scanStep * (double)panoramaWidth / 360.0);
+static_assert(panoramaColumnsPerScanStep == (Parameters::scanStep * (double)panoramaWidth / 360.0),
+              "Scan step must be a whole number of panorama columns");
+#endif  // BATCH_SCAN
 
 constexpr unsigned int numNoiseSources = Parameters::numPN + Parameters::numKC + Parameters::numEN;
 
@@ -102,6 +128,7 @@ enum Key
 typedef std::bitset<KeyMax> KeyBitset;
 
 //----------------------------------------------------------------------------
+#ifndef HEADLESS
 void keyCallback(GLFWwindow *window, int key, int, int action, int)
 {
     // If action isn't a press or a release, do nothing
@@ -210,7 +237,7 @@ void generateCubeFaceLookAtMatrices(GLfloat (&matrices)[6][16])
 }
 //----------------------------------------------------------------------------
 void renderAntView(float antX, float antY, float antHeading,
-                   const World &world, const RenderMesh &renderMesh,
+                   const World &world, const RenderMesh &renderMesh, int viewWidth,
                    GLuint cubemapFBO, GLuint cubemapTexture, const GLfloat (&cubeFaceLookAtMatrices)[6][16])
 {
     // Configure viewport to cubemap-sized square
@@ -262,7 +289,7 @@ void renderAntView(float antX, float antY, float antHeading,
 
     // Set viewport to strip at stop of window
     glViewport(0, displayRenderWidth + 10,
-               displayRenderWidth, displayRenderHeight);
+               viewWidth, displayRenderHeight);
 
     // Bind cubemap texture
     glEnable(GL_TEXTURE_CUBE_MAP);
@@ -308,6 +335,7 @@ void renderTopDownView(float antX, float antY, float antHeading,
     route.render(antX, antY, antHeading);
 
 }
+#endif  // HEADLESS
 //----------------------------------------------------------------------------
 unsigned int convertMsToTimesteps(double ms)
 {
@@ -498,16 +526,60 @@ std::tuple<unsigned int, unsigned int, unsigned int> presentToMB(float *inputDat
     return std::make_tuple(numPNSpikes, numKCSpikes, numENSpikes);
 }
 //----------------------------------------------------------------------------
+#ifdef BATCH_SCAN
+// Copy width columns starting at firstColumn out of 360 degree panorama, wrapping around
+void getPanoramaView(const cv::Mat &panorama, int firstColumn, int width, cv::Mat &view)
+{
+    view.create(panorama.rows, width, panorama.type());
+
+    firstColumn = ((firstColumn % panorama.cols) + panorama.cols) % panorama.cols;
+    const int numBeforeWrap = std::min(width, panorama.cols - firstColumn);
+    panorama.colRange(firstColumn, firstColumn + numBeforeWrap).copyTo(view.colRange(0, numBeforeWrap));
+    if(numBeforeWrap < width) {
+        panorama.colRange(0, width - numBeforeWrap).copyTo(view.colRange(numBeforeWrap, width));
+    }
+}
+//----------------------------------------------------------------------------
+// Present view at each heading of a scan, starting from panorama's heading, to
+// mushroom body back-to-back and return number of EN spikes each one caused
+std::vector<unsigned int> presentScanToMB(SnapshotProcessor &snapshotProcessor, const cv::Mat &panorama,
+                                          unsigned int numHeadings)
+{
+    Timer<> timer("\tScan:");
+
+    std::vector<unsigned int> numENSpikes;
+    numENSpikes.reserve(numHeadings);
+
+    cv::Mat view;
+    for(unsigned int h = 0; h < numHeadings; h++) {
+        // Rotate panorama to heading
+        getPanoramaView(panorama, ((panoramaWidth - panoramaViewWidth) / 2) + (h * panoramaColumnsPerScanStep),
+                        panoramaViewWidth, view);
+
+        // Process view and present to mushroom body
+        float *finalSnapshotData;
+        unsigned int finalSnapshotStep;
+        std::tie(finalSnapshotData, finalSnapshotStep) = snapshotProcessor.process(view);
+        numENSpikes.push_back(std::get<2>(presentToMB(finalSnapshotData, finalSnapshotStep, false)));
+    }
+
+    return numENSpikes;
+}
+#endif  // BATCH_SCAN
+//----------------------------------------------------------------------------
+#ifndef HEADLESS
 void handleGLFWError(int errorNumber, const char *message)
 {
     std::cerr << "GLFW error number:" << errorNumber << ", message:" << message << std::endl;
 }
+#endif  // HEADLESS
 }   // anonymous namespace
 //----------------------------------------------------------------------------
 int main(int argc, char *argv[])
 {
     std::mt19937 gen;
 
+#ifndef HEADLESS
     // Set GLFW error callback
     glfwSetErrorCallback(handleGLFWError);
 
@@ -540,7 +612,7 @@ int main(int argc, char *argv[])
     glfwSwapInterval(2);
 
     // Set clear colour to match matlab and enable depth test
-    glClearColor(0.0f, 1.0f, 1.0f, 1.0f);
+    glClearColor(skyColour[0], skyColour[1], skyColour[2], 1.0f);
     glEnable(GL_DEPTH_TEST);
     glLineWidth(4.0);
     glPointSize(4.0);
@@ -551,6 +623,10 @@ int main(int argc, char *argv[])
 
     // Set key callback
     glfwSetKeyCallback(window, keyCallback);
+#else
+    // No keys can be pressed without a window
+    KeyBitset keybits;
+#endif  // HEADLESS
 
     // Create route object and load route file specified by command line
     Route route(0.2f, 800);
@@ -558,16 +634,42 @@ int main(int argc, char *argv[])
         route.load(argv[1]);
     }
 
+#ifdef HEADLESS
+    // Without keyboard input, nothing will happen unless there's a route to train on and test
+    if(route.size() == 0) {
+        std::cerr << "Usage: ant_world <route filename>" << std::endl;
+        return EXIT_FAILURE;
+    }
+#else
     // Load world into OpenGL
     World world("world5000_gray.bin", worldColour, groundColour);
 
     // Build mesh to render cubemap to screen
-    // **NOTE** this matches the matlab:
-    // hfov = hfov/180/2*pi;
-    // axis([0 14 -hfov hfov -pi/12 pi/3]);
-    RenderMesh renderMesh(296.0f, 75.0f, 15.0f,
+    RenderMesh renderMesh(antViewHorizontalFOV, antViewVerticalFOV, antViewStartLongitude,
                           40, 10);
+#endif  // HEADLESS
+
+#ifdef BATCH_SCAN
+    // Panorama to render each test position into once and rotate to get the view at each heading of the scan
+#ifdef SOFTWARE_RENDERER
+    SoftwareRenderer panoramaRenderer(panoramaWidth, intermediateSnapshowHeight,
+                                      360.0f, antViewVerticalFOV, antViewStartLongitude,
+                                      skyColour, "world5000_gray.bin", worldColour, groundColour);
+#else
+    RenderMesh panoramaRenderMesh(360.0f, antViewVerticalFOV, antViewStartLongitude,
+                                  48, 10);
+#endif
+    cv::Mat panorama(displayRenderHeight, panoramaWidth, CV_8UC3);
+#endif  // BATCH_SCAN
+
+#ifdef SOFTWARE_RENDERER
+    // Load world into software renderer to render snapshots directly at intermediate resolution
+    SoftwareRenderer softwareRenderer(intermediateSnapshotWidth, intermediateSnapshowHeight,
+                                      antViewHorizontalFOV, antViewVerticalFOV, antViewStartLongitude,
+                                      skyColour, "world5000_gray.bin", worldColour, groundColour);
+#endif
 
+#ifndef HEADLESS
     // Create FBO for rendering to cubemap and bind
     GLuint fbo;
     glGenFramebuffers(1, &fbo);
@@ -611,6 +713,7 @@ int main(int argc, char *argv[])
     // Pre-generate lookat matrices to point at cubemap faces
     GLfloat cubeFaceLookAtMatrices[6][16];
     generateCubeFaceLookAtMatrices(cubeFaceLookAtMatrices);
+#endif  // HEADLESS
 
     // Initialize GeNN
     initGeNN(gen);
@@ -622,6 +725,12 @@ int main(int argc, char *argv[])
     SnapshotProcessor snapshotProcessor(intermediateSnapshotWidth, intermediateSnapshowHeight,
                                         Parameters::inputWidth, Parameters::inputHeight);
 
+#ifdef SNAPSHOT_CACHE
+    // Map cache of pre-rendered, pre-processed snapshots built by snapshot_cache_builder
+    SnapshotCache snapshotCache("snapshot_cache.bin");
+    cv::Mat cachedSnapshot;
+#endif
+
     // Initialize ant position
     float antX = 5.0f;
     float antY = 5.0f;
@@ -654,7 +763,25 @@ int main(int argc, char *argv[])
     std::ofstream spin;
 
     std::future<std::tuple<unsigned int, unsigned int, unsigned int>> gennResult;
+#ifdef BATCH_SCAN
+    std::future<std::vector<unsigned int>> scanResult;
+#endif
+#ifdef HEADLESS
+    // Run until route has been trained on and tested
+    // **NOTE** when testing completes, state returns to idle with no simulation outstanding
+    while(state != State::Idle) {
+        // With no window to keep responsive, wait for any outstanding simulation rather than polling
+        if(gennResult.valid()) {
+            gennResult.wait();
+        }
+#ifdef BATCH_SCAN
+        if(scanResult.valid()) {
+            scanResult.wait();
+        }
+#endif  // BATCH_SCAN
+#else
     while (!glfwWindowShouldClose(window)) {
+#endif  // HEADLESS
         // If there is no valid result (GeNN process has never run), we are ready to take a snapshot
         bool readyForNextSnapshot = false;
         bool resultsAvailable = false;
@@ -673,6 +800,21 @@ int main(int argc, char *argv[])
             resultsAvailable = true;
         }
 
+#ifdef BATCH_SCAN
+        // If a batched scan is running, we're only ready once it's complete
+        bool scanResultsAvailable = false;
+        std::vector<unsigned int> scanENSpikes;
+        if(scanResult.valid()) {
+            if(scanResult.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                scanENSpikes = scanResult.get();
+                scanResultsAvailable = true;
+            }
+            else {
+                readyForNextSnapshot = false;
+            }
+        }
+#endif
+
         // Update heading and ant position based on keys
         bool trainSnapshot = false;
         bool testSnapshot = false;
@@ -728,9 +870,11 @@ int main(int argc, char *argv[])
                     // Snap ant to next snapshot point
                     std::tie(antX, antY, antHeading) = route[trainPoint];
 
+#ifndef HEADLESS
                     // Update window title
                     std::string windowTitle = "Ant World - Training snaphot " + std::to_string(trainPoint) + "/" + std::to_string(route.size());
                     glfwSetWindowTitle(window, windowTitle.c_str());
+#endif
 
                     // Set flag to train this snapshot
                     trainSnapshot = true;
@@ -763,6 +907,26 @@ int main(int argc, char *argv[])
         }
         // Otherwise, if we're testing
         else if(state == State::Testing) {
+            bool scanComplete = false;
+#ifdef BATCH_SCAN
+            if(scanResultsAvailable) {
+                // Find most familiar of the headings extracted from panorama
+                for(unsigned int h = 0; h < numScanSteps; h++) {
+                    if(scanENSpikes[h] < bestTestENSpikes) {
+                        bestHeading = antHeading + (h * Parameters::scanStep);
+                        bestTestENSpikes = scanENSpikes[h];
+                    }
+                }
+
+#ifndef HEADLESS
+                // Update window title
+                std::string windowTitle = "Ant World - Testing with " + std::to_string(numErrors) + " errors";
+                glfwSetWindowTitle(window, windowTitle.c_str());
+#endif
+
+                scanComplete = true;
+            }
+#else
             if(resultsAvailable) {
                 // If this is an improvement on previous best spike count
                 if(numENSpikes < bestTestENSpikes) {
@@ -772,9 +936,11 @@ int main(int argc, char *argv[])
                     std::cout << "\tUpdated result: " << bestHeading << " is most familiar heading with " << bestTestENSpikes << " spikes" << std::endl;
                 }
 
+#ifndef HEADLESS
                 // Update window title
                 std::string windowTitle = "Ant World - Testing with " + std::to_string(numErrors) + " errors";
                 glfwSetWindowTitle(window, windowTitle.c_str());
+#endif
 
                 // Go onto next scan
                 testingScan++;
@@ -788,58 +954,63 @@ int main(int argc, char *argv[])
                     testSnapshot = true;
                 }
                 else {
-                    std::cout << "Scan complete: " << bestHeading << " is most familiar heading with " << bestTestENSpikes << " spikes" << std::endl;
+                    scanComplete = true;
+                }
+            }
+#endif  // BATCH_SCAN
 
-                    // Snap ant to it's best heading
-                    antHeading = bestHeading;
+            if(scanComplete) {
+                std::cout << "Scan complete: " << bestHeading << " is most familiar heading with " << bestTestENSpikes << " spikes" << std::endl;
 
-                    // Move ant forward by snapshot distance
-                    antX += Parameters::snapshotDistance * sin(antHeading * degreesToRadians);
-                    antY += Parameters::snapshotDistance * cos(antHeading * degreesToRadians);
+                // Snap ant to it's best heading
+                antHeading = bestHeading;
 
-                    // If we've reached destination
-                    if(route.atDestination(antX, antY, Parameters::errorDistance)) {
-                        std::cout << "Destination reached with " << numErrors << " errors" << std::endl;
+                // Move ant forward by snapshot distance
+                antX += Parameters::snapshotDistance * sin(antHeading * degreesToRadians);
+                antY += Parameters::snapshotDistance * cos(antHeading * degreesToRadians);
 
-                        // Reset state to idle
-                        state = State::Idle;
+                // If we've reached destination
+                if(route.atDestination(antX, antY, Parameters::errorDistance)) {
+                    std::cout << "Destination reached with " << numErrors << " errors" << std::endl;
 
-                        // Add final point to route
-                        route.addPoint(antX, antY, false);
+                    // Reset state to idle
+                    state = State::Idle;
+
+                    // Add final point to route
+                    route.addPoint(antX, antY, false);
+                }
+                // Otherwise
+                else {
+                    // Calculate distance to route
+                    float distanceToRoute;
+                    size_t nearestRouteWaypoint;
+                    std::tie(distanceToRoute, nearestRouteWaypoint) = route.getDistanceToRoute(antX, antY);
+                    std::cout << "\tDistance to route: " << distanceToRoute * 100.0f << "cm" << std::endl;
+
+                    // If we are further away than error threshold
+                    if(distanceToRoute > Parameters::errorDistance) {
+                        // Snap ant to next snapshot position
+                        // **HACK** this is dubious but looks very much like what the original model was doing in figure 1i
+                        std::tie(antX, antY, antHeading) = route[nearestRouteWaypoint + 1];
+
+                        // Add error point to route
+                        route.addPoint(antX, antY, true);
+
+                        // Increment error counter
+                        numErrors++;
                     }
-                    // Otherwise
+                    // Otherwise add 'correct' point to route
                     else {
-                        // Calculate distance to route
-                        float distanceToRoute;
-                        size_t nearestRouteWaypoint;
-                        std::tie(distanceToRoute, nearestRouteWaypoint) = route.getDistanceToRoute(antX, antY);
-                        std::cout << "\tDistance to route: " << distanceToRoute * 100.0f << "cm" << std::endl;
-
-                        // If we are further away than error threshold
-                        if(distanceToRoute > Parameters::errorDistance) {
-                            // Snap ant to next snapshot position
-                            // **HACK** this is dubious but looks very much like what the original model was doing in figure 1i
-                            std::tie(antX, antY, antHeading) = route[nearestRouteWaypoint + 1];
-
-                            // Add error point to route
-                            route.addPoint(antX, antY, true);
-
-                            // Increment error counter
-                            numErrors++;
-                        }
-                        // Otherwise add 'correct' point to route
-                        else {
-                            route.addPoint(antX, antY, false);
-                        }
-
-                        // Reset scan
-                        antHeading -= halfScanAngle;
-                        testingScan = 0;
-                        bestTestENSpikes = std::numeric_limits<unsigned int>::max();
-
-                        // Take snapshot
-                        testSnapshot = true;
+                        route.addPoint(antX, antY, false);
                     }
+
+                    // Reset scan
+                    antHeading -= halfScanAngle;
+                    testingScan = 0;
+                    bestTestENSpikes = std::numeric_limits<unsigned int>::max();
+
+                    // Take snapshot
+                    testSnapshot = true;
                 }
             }
         }
@@ -921,12 +1092,13 @@ int main(int argc, char *argv[])
             }
         }
 
+#ifndef HEADLESS
         // Clear colour and depth buffer
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // Render ant's eye view at top of the screen
         renderAntView(antX, antY, antHeading,
-                      world, renderMesh,
+                      world, renderMesh, displayRenderWidth,
                       fbo, cubemap, cubeFaceLookAtMatrices);
 
         // Render top-down view at bottom of the screen
@@ -936,6 +1108,35 @@ int main(int argc, char *argv[])
 
         // Swap front and back buffers
         glfwSwapBuffers(window);
+#endif  // HEADLESS
+
+#ifdef BATCH_SCAN
+        // If we should start a test scan, render panorama and present every heading to network in one go
+        if(testSnapshot && state == State::Testing) {
+            Timer<> timer("\tPanorama generation:");
+
+            std::cout << "Panorama at (" << antX << "," << antY << "," << antHeading << ")" << std::endl;
+
+            // Render panorama centred on first heading of scan
+            // **NOTE** view at each heading of scan is then panoramaColumnsPerScanStep columns further right
+#ifdef SOFTWARE_RENDERER
+            panoramaRenderer.render(antX, antY, antHeading, panorama);
+#else
+            // Render panorama into back buffer and read it straight back
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            renderAntView(antX, antY, antHeading,
+                          world, panoramaRenderMesh, panoramaWidth,
+                          fbo, cubemap, cubeFaceLookAtMatrices);
+            glReadPixels(0, displayRenderWidth + 10, panoramaWidth, displayRenderHeight,
+                         GL_BGR, GL_UNSIGNED_BYTE, panorama.data);
+#endif
+
+            // Start simulating each heading
+            scanResult = std::async(std::launch::async, presentScanToMB,
+                                    std::ref(snapshotProcessor), panorama.clone(), numScanSteps);
+            testSnapshot = false;
+        }
+#endif  // BATCH_SCAN
 
         // If we should take a snapshot
         if(trainSnapshot || testSnapshot) {
@@ -943,25 +1144,40 @@ int main(int argc, char *argv[])
 
             std::cout << "Snapshot at (" << antX << "," << antY << "," << antHeading << ")" << std::endl;
 
+            float *finalSnapshotData;
+            unsigned int finalSnapshotStep;
+#ifdef SNAPSHOT_CACHE
+            // Interpolate snapshot from cache and upload it
+            snapshotCache.lookup(antX, antY, antHeading, SnapshotCache::Interpolation::Bilinear, cachedSnapshot);
+            std::tie(finalSnapshotData, finalSnapshotStep) = snapshotProcessor.upload(cachedSnapshot);
+#else
+#ifdef SOFTWARE_RENDERER
+            // Render snapshot on CPU
+            softwareRenderer.render(antX, antY, antHeading, snapshot);
+#else
             // Read pixels from framebuffer
             // **TODO** it should be theoretically possible to go directly from frame buffer to GpuMat
             glReadPixels(0, displayRenderWidth + 10, displayRenderWidth, displayRenderHeight,
                          GL_BGR, GL_UNSIGNED_BYTE, snapshot.data);
+#endif
 
             // Process snapshot
-            float *finalSnapshotData;
-            unsigned int finalSnapshotStep;
             std::tie(finalSnapshotData, finalSnapshotStep) = snapshotProcessor.process(snapshot);
+#endif  // SNAPSHOT_CACHE
 
             // Start simulation, applying reward if we are training
             gennResult = std::async(std::launch::async, presentToMB,
                                     finalSnapshotData, finalSnapshotStep, trainSnapshot);
         }
 
+#ifndef HEADLESS
         // Poll for and process events
         glfwPollEvents();
+#endif
     }
 
+#ifndef HEADLESS
     glfwTerminate();
+#endif
     return 0;
 }
\ No newline at end of file
@@ -9,4 +9,25 @@
 // Constants
 //----------------------------------------------------------------------------
 constexpr float degreesToRadians = 0.017453293f;
-constexpr float radiansToDegrees = 57.295779513f;
\ No newline at end of file
+constexpr float radiansToDegrees = 57.295779513f;
+
+// What colour should the ground be?
+constexpr float groundColour[] = {0.898f, 0.718f, 0.353f};
+
+// What colour should the brightest tussocks be?
+constexpr float worldColour[] = {0.0f, 1.0f, 0.0f};
+
+// What colour should the sky be?
+constexpr float skyColour[] = {0.0f, 1.0f, 1.0f};
+
+// Resolution snapshots are downsampled to before histogram normalization
+constexpr int intermediateSnapshotWidth = 74;
+constexpr int intermediateSnapshowHeight = 19;
+
+// Field of view of ant's eye view
+// **NOTE** this matches the matlab:
+// hfov = hfov/180/2*pi;
+// axis([0 14 -hfov hfov -pi/12 pi/3]);
+constexpr float antViewHorizontalFOV = 296.0f;
+constexpr float antViewVerticalFOV = 75.0f;
+constexpr float antViewStartLongitude = 15.0f;
\ No newline at end of file
@@ -1,12 +1,14 @@
 #include "route.h"
 
 // Standard C++ includes
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <stdexcept>
 #include <tuple>
 
-// Standard C++ includes
+// Standard C includes
 #include <cassert>
 #include <cmath>
 
@@ -27,16 +29,40 @@ float distanceSquared(float x1, float y1, float x2, float y2)
 {
     return sqr(x2 - x1) + sqr(y2 - y1);
 }
+//----------------------------------------------------------------------------
+// Get squared distance from point to line segment between start and end and how far along segment closest point is
+std::tuple<float, float> segmentDistanceSquared(float x, float y, const std::array<float, 2> &start, const std::array<float, 2> &end)
+{
+    const float dx = end[0] - start[0];
+    const float dy = end[1] - start[1];
+    const float lengthSquared = sqr(dx) + sqr(dy);
+    const float t = (lengthSquared > 0.0f) ? std::min(1.0f, std::max(0.0f, (((x - start[0]) * dx) + ((y - start[1]) * dy)) / lengthSquared)) : 0.0f;
+    return std::make_tuple(distanceSquared(x, y, start[0] + (t * dx), start[1] + (t * dy)), t);
+}
+//----------------------------------------------------------------------------
+// Size of spatial index grid cells (m)
+// **NOTE** waypoints are 10cm apart so each cell contains a few segments of any route which passes through it
+constexpr float gridCellSize = 0.25f;
 }   // Anonymous namespace
 
 //----------------------------------------------------------------------------
 // Route
 //----------------------------------------------------------------------------
 Route::Route(float arrowLength, unsigned int maxRouteEntries)
-    : m_WaypointsVAO(0), m_WaypointsPositionVBO(0), m_WaypointsColourVBO(0),
-    m_RouteVAO(0), m_RoutePositionVBO(0), m_RouteColourVBO(0), m_RouteNumPoints(0), m_RouteMaxPoints(maxRouteEntries),
-    m_OverlayVAO(0), m_OverlayPositionVBO(0), m_OverlayColoursVBO(0)
+    :
+#ifndef HEADLESS
+    m_WaypointsVAO(0), m_WaypointsPositionVBO(0), m_WaypointsColourVBO(0),
+    m_RouteVAO(0), m_RoutePositionVBO(0), m_RouteColourVBO(0),
+#endif
+    m_RouteNumPoints(0), m_RouteMaxPoints(maxRouteEntries),
+    m_GridMinX(0.0f), m_GridMinY(0.0f), m_GridWidth(0), m_GridHeight(0)
+#ifndef HEADLESS
+    , m_OverlayVAO(0), m_OverlayPositionVBO(0), m_OverlayColoursVBO(0)
+#endif
 {
+#ifdef HEADLESS
+    (void)arrowLength;
+#else
     const GLfloat arrowPositions[] = {
         0.0f, 0.0f,
         0.0f, arrowLength,
@@ -99,6 +125,7 @@ Route::Route(float arrowLength, unsigned int maxRouteEntries)
     // Set colour pointer and enable client state in VAO
     glColorPointer(3, GL_UNSIGNED_BYTE, 0, BUFFER_OFFSET(0));
     glEnableClientState(GL_COLOR_ARRAY);
+#endif  // HEADLESS
 }
 //----------------------------------------------------------------------------
 Route::Route(float arrowLength, unsigned int maxRouteEntries, const std::string &filename)
@@ -111,6 +138,7 @@ Route::Route(float arrowLength, unsigned int maxRouteEntries, const std::string
 //----------------------------------------------------------------------------
 Route::~Route()
 {
+#ifndef HEADLESS
     // Delete waypoint objects
     glDeleteBuffers(1, &m_WaypointsPositionVBO);
     glDeleteVertexArrays(1, &m_WaypointsColourVBO);
@@ -125,6 +153,7 @@ Route::~Route()
     glDeleteBuffers(1, &m_OverlayPositionVBO);
     glDeleteBuffers(1, &m_OverlayColoursVBO);
     glDeleteVertexArrays(1, &m_OverlayVAO);
+#endif  // HEADLESS
 }
 //----------------------------------------------------------------------------
 bool Route::load(const std::string &filename)
@@ -200,6 +229,10 @@ bool Route::load(const std::string &filename)
         waypoint[1] = prevWaypoint[1] - (0.1f * sin(headingRadians));
     }
 
+    // Build spatial index of realigned segments
+    buildSegmentGrid();
+
+#ifndef HEADLESS
     // Create a vertex array object to bind everything together
     glGenVertexArrays(1, &m_WaypointsVAO);
 
@@ -228,9 +261,11 @@ bool Route::load(const std::string &filename)
         glColorPointer(3, GL_UNSIGNED_BYTE, 0, BUFFER_OFFSET(0));
         glEnableClientState(GL_COLOR_ARRAY);
     }
+#endif  // HEADLESS
     return true;
 }
 //----------------------------------------------------------------------------
+#ifndef HEADLESS
 void Route::render(float antX, float antY, float antHeading) const
 {
     // Bind route VAO
@@ -255,6 +290,7 @@ void Route::render(float antX, float antY, float antHeading) const
     glPopMatrix();
 
 }
+#endif  // HEADLESS
 //----------------------------------------------------------------------------
 bool Route::atDestination(float x, float y, float threshold) const
 {
@@ -270,26 +306,129 @@ bool Route::atDestination(float x, float y, float threshold) const
 //----------------------------------------------------------------------------
 std::tuple<float, size_t> Route::getDistanceToRoute(float x, float y) const
 {
-    // Loop through segments
+    // If there are no segments, just use distance to waypoint if there is one
+    if(m_Waypoints.empty()) {
+        return std::make_tuple(std::numeric_limits<float>::max(), 0);
+    }
+    else if(m_Waypoints.size() == 1) {
+        return std::make_tuple(sqrt(distanceSquared(x, y, m_Waypoints[0][0], m_Waypoints[0][1])), 0);
+    }
+
+    // Get cell containing point, clamped to grid
+    const int cellX = std::min((int)m_GridWidth - 1, std::max(0, (int)std::floor((x - m_GridMinX) / gridCellSize)));
+    const int cellY = std::min((int)m_GridHeight - 1, std::max(0, (int)std::floor((y - m_GridMinY) / gridCellSize)));
+
+    // Search outwards through square rings of cells around this one
+    // **NOTE** segments in cells outside ring r - 1 are at least r - 1 cells away
+    // so, once the nearest segment is closer than that, we can stop
     float minimumDistanceSquared = std::numeric_limits<float>::max();
-    size_t nearestWaypoint;
-    for(unsigned int s = 0; s < m_Waypoints.size(); s++)
-    {
-        const float distanceToWaypointSquared = distanceSquared(x, y, m_Waypoints[s][0], m_Waypoints[s][1]);
+    size_t nearestSegment = 0;
+    float nearestT = 0.0f;
+    const int maxRing = (int)std::max(m_GridWidth, m_GridHeight);
+    for(int r = 0; r <= maxRing && minimumDistanceSquared > sqr((float)(r - 1) * gridCellSize); r++) {
+        for(int j = cellY - r; j <= cellY + r; j++) {
+            if(j < 0 || j >= (int)m_GridHeight) {
+                continue;
+            }
 
-        // If this is closer than current minimum, update minimum and nearest waypoint
-        if(distanceToWaypointSquared < minimumDistanceSquared) {
-            minimumDistanceSquared = distanceToWaypointSquared;
-            nearestWaypoint = s;
+            // Loop through cells in this row which lie on ring
+            const bool edgeRow = (j == (cellY - r) || j == (cellY + r));
+            for(int i = cellX - r; i <= cellX + r; i += (edgeRow || r == 0) ? 1 : (2 * r)) {
+                if(i < 0 || i >= (int)m_GridWidth) {
+                    continue;
+                }
+
+                // Loop through segments in cell
+                const unsigned int cell = (j * m_GridWidth) + i;
+                for(unsigned int c = m_GridCellStart[cell]; c < m_GridCellStart[cell + 1]; c++) {
+                    const unsigned int s = m_GridSegments[c];
+
+                    float segmentDistance;
+                    float t;
+                    std::tie(segmentDistance, t) = segmentDistanceSquared(x, y, m_Waypoints[s], m_Waypoints[s + 1]);
+
+                    // If this is closer than current minimum, update minimum and nearest segment
+                    // **NOTE** segments spanning multiple cells may be tested repeatedly but this is harmless
+                    if(segmentDistance < minimumDistanceSquared) {
+                        minimumDistanceSquared = segmentDistance;
+                        nearestSegment = s;
+                        nearestT = t;
+                    }
+                }
+            }
         }
     }
 
-    // Return the minimum distance to the path and the segment in which this occured
-    return std::make_tuple(sqrt(minimumDistanceSquared), nearestWaypoint);
+    // Return the minimum distance to the path and whichever end of the nearest segment is closest
+    return std::make_tuple(sqrt(minimumDistanceSquared), (nearestT < 0.5f) ? nearestSegment : (nearestSegment + 1));
+}
+//----------------------------------------------------------------------------
+void Route::buildSegmentGrid()
+{
+    m_GridCellStart.clear();
+    m_GridSegments.clear();
+    if(m_Waypoints.size() < 2) {
+        return;
+    }
+
+    // Get bounds of route
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+    m_GridMinX = std::numeric_limits<float>::max();
+    m_GridMinY = std::numeric_limits<float>::max();
+    for(const auto &w : m_Waypoints) {
+        m_GridMinX = std::min(m_GridMinX, w[0]);
+        m_GridMinY = std::min(m_GridMinY, w[1]);
+        maxX = std::max(maxX, w[0]);
+        maxY = std::max(maxY, w[1]);
+    }
+    m_GridWidth = (unsigned int)std::floor((maxX - m_GridMinX) / gridCellSize) + 1;
+    m_GridHeight = (unsigned int)std::floor((maxY - m_GridMinY) / gridCellSize) + 1;
+
+    // Get range of cells overlapped by bounding box of each segment
+    const unsigned int numSegments = m_Waypoints.size() - 1;
+    std::vector<std::array<unsigned int, 4>> segmentCells(numSegments);
+    for(unsigned int s = 0; s < numSegments; s++) {
+        const auto &start = m_Waypoints[s];
+        const auto &end = m_Waypoints[s + 1];
+        segmentCells[s] = {{std::min(m_GridWidth - 1, (unsigned int)((std::min(start[0], end[0]) - m_GridMinX) / gridCellSize)),
+                            std::min(m_GridWidth - 1, (unsigned int)((std::max(start[0], end[0]) - m_GridMinX) / gridCellSize)),
+                            std::min(m_GridHeight - 1, (unsigned int)((std::min(start[1], end[1]) - m_GridMinY) / gridCellSize)),
+                            std::min(m_GridHeight - 1, (unsigned int)((std::max(start[1], end[1]) - m_GridMinY) / gridCellSize))}};
+    }
+
+    // Count segments in each cell and convert counts to start indices
+    m_GridCellStart.assign((m_GridWidth * m_GridHeight) + 1, 0);
+    for(const auto &c : segmentCells) {
+        for(unsigned int j = c[2]; j <= c[3]; j++) {
+            for(unsigned int i = c[0]; i <= c[1]; i++) {
+                m_GridCellStart[(j * m_GridWidth) + i + 1]++;
+            }
+        }
+    }
+    for(unsigned int i = 1; i < m_GridCellStart.size(); i++) {
+        m_GridCellStart[i] += m_GridCellStart[i - 1];
+    }
+
+    // Fill in segments
+    m_GridSegments.resize(m_GridCellStart.back());
+    std::vector<unsigned int> cellEnd(m_GridCellStart.begin(), m_GridCellStart.end() - 1);
+    for(unsigned int s = 0; s < numSegments; s++) {
+        const auto &c = segmentCells[s];
+        for(unsigned int j = c[2]; j <= c[3]; j++) {
+            for(unsigned int i = c[0]; i <= c[1]; i++) {
+                m_GridSegments[cellEnd[(j * m_GridWidth) + i]++] = s;
+            }
+        }
+    }
 }
 //----------------------------------------------------------------------------
 void Route::setWaypointFamiliarity(size_t pos, double familiarity)
 {
+#ifdef HEADLESS
+    (void)pos;
+    (void)familiarity;
+#else
     // Convert familiarity to a grayscale colour
     const uint8_t intensity = (uint8_t)std::min(255.0, std::max(0.0, std::round(255.0 * familiarity)));
     const uint8_t colour[3] = {intensity, intensity, intensity};
@@ -297,11 +436,16 @@ void Route::setWaypointFamiliarity(size_t pos, double familiarity)
     // Update this positions colour in colour buffer
     glBindBuffer(GL_ARRAY_BUFFER, m_WaypointsColourVBO);
     glBufferSubData(GL_ARRAY_BUFFER, pos * sizeof(uint8_t) * 3, sizeof(uint8_t) * 3, colour);
-
+#endif  // HEADLESS
 }
 //----------------------------------------------------------------------------
 void Route::addPoint(float x, float y, bool error)
 {
+#ifdef HEADLESS
+    (void)x;
+    (void)y;
+    (void)error;
+#else
     const static uint8_t errorColour[3] = {0xFF, 0, 0};
     const static uint8_t correctColour[3] = {0, 0xFF, 0};
 
@@ -316,6 +460,7 @@ void Route::addPoint(float x, float y, bool error)
     glBindBuffer(GL_ARRAY_BUFFER, m_RoutePositionVBO);
     glBufferSubData(GL_ARRAY_BUFFER, m_RouteNumPoints * sizeof(float) * 2,
                     sizeof(float) * 2, position);
+#endif  // HEADLESS
 
     m_RouteNumPoints++;
 }
@@ -7,12 +7,16 @@
 #include <vector>
 
 // OpenGL includes
-#include <GL/glew.h>
-#include <GL/glu.h>
+#ifndef HEADLESS
+    #include <GL/glew.h>
+    #include <GL/glu.h>
+#endif
 
 //----------------------------------------------------------------------------
 // Route
 //----------------------------------------------------------------------------
+//! Route waypoints loaded from file and route taken while testing. When built
+//! with HEADLESS, no OpenGL objects are created and the route can't be rendered
 class Route
 {
 public:
@@ -24,7 +28,9 @@ public:
     // Public API
     //------------------------------------------------------------------------
     bool load(const std::string &filename);
+#ifndef HEADLESS
     void render(float antX, float antY, float antHeading) const;
+#endif
 
     bool atDestination(float x, float y, float threshold) const;
     std::tuple<float, size_t> getDistanceToRoute(float x, float y) const;
@@ -39,9 +45,15 @@ public:
     std::tuple<float, float, float> operator[](size_t waypoint) const;
 
 private:
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    void buildSegmentGrid();
+
     //------------------------------------------------------------------------
     // Members
     //------------------------------------------------------------------------
+#ifndef HEADLESS
     GLuint m_WaypointsVAO;
     GLuint m_WaypointsPositionVBO;
     GLuint m_WaypointsColourVBO;
@@ -49,6 +61,7 @@ private:
     GLuint m_RouteVAO;
     GLuint m_RoutePositionVBO;
     GLuint m_RouteColourVBO;
+#endif
     unsigned int m_RouteNumPoints;
     const unsigned int m_RouteMaxPoints;
 
@@ -56,7 +69,18 @@ private:
     std::vector<float> m_HeadingDegrees;
     std::set<size_t> m_TrainedSnapshots;
 
+    // Uniform grid indexing which route segments pass through each cell;
+    // segments in cell i are m_GridSegments[m_GridCellStart[i]:m_GridCellStart[i + 1]]
+    float m_GridMinX;
+    float m_GridMinY;
+    unsigned int m_GridWidth;
+    unsigned int m_GridHeight;
+    std::vector<unsigned int> m_GridCellStart;
+    std::vector<unsigned int> m_GridSegments;
+
+#ifndef HEADLESS
     GLuint m_OverlayVAO;
     GLuint m_OverlayPositionVBO;
     GLuint m_OverlayColoursVBO;
+#endif
 };
\ No newline at end of file
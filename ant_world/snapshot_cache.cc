@@ -0,0 +1,164 @@
+#include "snapshot_cache.h"
+
+// Standard C++ includes
+#include <algorithm>
+#include <stdexcept>
+
+// Standard C includes
+#include <cmath>
+#include <cstring>
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//----------------------------------------------------------------------------
+// Anonymous namespace
+//----------------------------------------------------------------------------
+namespace
+{
+const char magic[8] = {'A', 'N', 'T', 'S', 'N', 'A', 'P', 'S'};
+const uint32_t version = 1;
+
+static_assert(sizeof(SnapshotCache::Header) == 48, "Snapshot cache header should be tightly packed");
+
+// Convert world coordinate to fractional grid index, clamped to grid
+float getGridIndex(float position, float min, float spacing, unsigned int num)
+{
+    return std::min((float)(num - 1), std::max(0.0f, (position - min) / spacing));
+}
+}   // Anonymous namespace
+
+//----------------------------------------------------------------------------
+// SnapshotCache
+//----------------------------------------------------------------------------
+SnapshotCache::SnapshotCache(const std::string &filename)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw std::runtime_error("Cannot open snapshot cache '" + filename + "'");
+    }
+
+    // Get file size and check it's large enough to contain a header
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || (size_t)fileStat.st_size < sizeof(Header)) {
+        close(fd);
+        throw std::runtime_error("Snapshot cache '" + filename + "' is truncated");
+    }
+
+    // Map file into memory
+    // **NOTE** lookups are scattered across the file so don't bother with read-ahead
+    m_MappingSize = (size_t)fileStat.st_size;
+    m_Mapping = mmap(nullptr, m_MappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(m_Mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map snapshot cache '" + filename + "'");
+    }
+    madvise(m_Mapping, m_MappingSize, MADV_RANDOM);
+
+    // Check header and file size
+    m_Header = reinterpret_cast<const Header*>(m_Mapping);
+    m_Snapshots = reinterpret_cast<const uint8_t*>(m_Header + 1);
+    if(memcmp(m_Header->magic, magic, sizeof(magic)) != 0 || m_Header->version != version) {
+        munmap(m_Mapping, m_MappingSize);
+        throw std::runtime_error("'" + filename + "' is not a version " + std::to_string(version) + " snapshot cache");
+    }
+    if(m_MappingSize != getFileSize(*m_Header)) {
+        munmap(m_Mapping, m_MappingSize);
+        throw std::runtime_error("Snapshot cache '" + filename + "' is the wrong size for its grid");
+    }
+}
+//----------------------------------------------------------------------------
+SnapshotCache::~SnapshotCache()
+{
+    munmap(m_Mapping, m_MappingSize);
+}
+//----------------------------------------------------------------------------
+void SnapshotCache::lookup(float x, float y, float heading, Interpolation interpolation, cv::Mat &snapshot) const
+{
+    const unsigned int numPixels = m_Header->snapshotWidth * m_Header->snapshotHeight;
+    snapshot.create(m_Header->snapshotHeight, m_Header->snapshotWidth, CV_32FC1);
+
+    // Convert position and heading to fractional grid indices
+    const float gridX = getGridIndex(x, m_Header->minX, m_Header->spacing, m_Header->numX);
+    const float gridY = getGridIndex(y, m_Header->minY, m_Header->spacing, m_Header->numY);
+    float gridHeading = std::fmod(heading / m_Header->headingStep, (float)m_Header->numHeadings);
+    if(gridHeading < 0.0f) {
+        gridHeading += (float)m_Header->numHeadings;
+    }
+
+    if(interpolation == Interpolation::Nearest) {
+        const unsigned int nearestHeading = (unsigned int)std::round(gridHeading) % m_Header->numHeadings;
+        const cv::Mat nearest(m_Header->snapshotHeight, m_Header->snapshotWidth, CV_8UC1,
+                              const_cast<uint8_t*>(getSnapshot((unsigned int)std::round(gridX), (unsigned int)std::round(gridY), nearestHeading)));
+        nearest.convertTo(snapshot, CV_32FC1, 1.0 / 255.0);
+    }
+    else {
+        // Get surrounding grid indices and weights
+        // **NOTE** headings wrap around but positions are clamped
+        const unsigned int x0 = (unsigned int)gridX;
+        const unsigned int y0 = (unsigned int)gridY;
+        const unsigned int h0 = (unsigned int)gridHeading % m_Header->numHeadings;
+        const unsigned int xi[2] = {x0, std::min(x0 + 1, m_Header->numX - 1)};
+        const unsigned int yi[2] = {y0, std::min(y0 + 1, m_Header->numY - 1)};
+        const unsigned int hi[2] = {h0, (h0 + 1) % m_Header->numHeadings};
+        const float tx = gridX - (float)x0;
+        const float ty = gridY - (float)y0;
+        const float th = gridHeading - std::floor(gridHeading);
+
+        // Accumulate weighted sum of the 8 surrounding snapshots
+        float *output = snapshot.ptr<float>();
+        std::fill_n(output, numPixels, 0.0f);
+        for(unsigned int j = 0; j < 8; j++) {
+            const unsigned int bx = j & 1;
+            const unsigned int by = (j >> 1) & 1;
+            const unsigned int bh = (j >> 2) & 1;
+            const float weight = (bx ? tx : (1.0f - tx)) * (by ? ty : (1.0f - ty)) * (bh ? th : (1.0f - th)) / 255.0f;
+            if(weight == 0.0f) {
+                continue;
+            }
+
+            const uint8_t *input = getSnapshot(xi[bx], yi[by], hi[bh]);
+            for(unsigned int p = 0; p < numPixels; p++) {
+                output[p] += weight * (float)input[p];
+            }
+        }
+    }
+
+    // Normalise snapshot using L2 norm
+    cv::normalize(snapshot, snapshot);
+}
+//----------------------------------------------------------------------------
+SnapshotCache::Header SnapshotCache::createHeader(unsigned int numX, unsigned int numY, unsigned int numHeadings,
+                                                  unsigned int snapshotWidth, unsigned int snapshotHeight,
+                                                  float minX, float minY, float spacing)
+{
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.numX = numX;
+    header.numY = numY;
+    header.numHeadings = numHeadings;
+    header.snapshotWidth = snapshotWidth;
+    header.snapshotHeight = snapshotHeight;
+    header.minX = minX;
+    header.minY = minY;
+    header.spacing = spacing;
+    header.headingStep = 360.0f / (float)numHeadings;
+    return header;
+}
+//----------------------------------------------------------------------------
+size_t SnapshotCache::getFileSize(const Header &header)
+{
+    return sizeof(Header) + ((size_t)header.numX * header.numY * header.numHeadings
+                             * header.snapshotWidth * header.snapshotHeight);
+}
+//----------------------------------------------------------------------------
+const uint8_t *SnapshotCache::getSnapshot(unsigned int x, unsigned int y, unsigned int heading) const
+{
+    const size_t snapshotSize = (size_t)m_Header->snapshotWidth * m_Header->snapshotHeight;
+    return m_Snapshots + (((((size_t)y * m_Header->numX) + x) * m_Header->numHeadings) + heading) * snapshotSize;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// Standard C++ includes
+#include <string>
+
+// Standard C includes
+#include <cstdint>
+
+// OpenCV includes
+#include <opencv2/opencv.hpp>
+
+//----------------------------------------------------------------------------
+// SnapshotCache
+//----------------------------------------------------------------------------
+//! Memory-mapped tensor of processed snapshots, pre-rendered by
+//! snapshot_cache_builder over a regular (x, y, heading) grid of the world.
+//! Snapshots are stored as the 8-bit output of SnapshotProcessor::processHost
+//! and looked up snapshots are converted to floating point and L2 normalised,
+//! exactly like SnapshotProcessor::process, so they can be uploaded directly.
+//! lookup is const so one cache can be shared between threads.
+class SnapshotCache
+{
+public:
+    //------------------------------------------------------------------------
+    // Enumerations
+    //------------------------------------------------------------------------
+    enum class Interpolation
+    {
+        Nearest,    //!< Use snapshot at nearest grid position and heading
+        Bilinear,   //!< Bilinearly interpolate between surrounding grid positions and linearly between headings
+    };
+
+    //------------------------------------------------------------------------
+    // Header
+    //------------------------------------------------------------------------
+    //! Header at the start of each cache file. Snapshots follow it in
+    //! [y][x][heading][row][column] order so each one is contiguous
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t numX;
+        uint32_t numY;
+        uint32_t numHeadings;
+        uint32_t snapshotWidth;
+        uint32_t snapshotHeight;
+        float minX;
+        float minY;
+        float spacing;
+        float headingStep;
+    };
+
+    SnapshotCache(const std::string &filename);
+    ~SnapshotCache();
+
+    SnapshotCache(const SnapshotCache&) = delete;
+    SnapshotCache &operator=(const SnapshotCache&) = delete;
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Get snapshot at position and heading as CV_32FC1 matrix. Positions
+    //! outside the grid are clamped to its edge
+    void lookup(float x, float y, float heading, Interpolation interpolation, cv::Mat &snapshot) const;
+
+    const Header &getHeader() const{ return *m_Header; }
+
+    //------------------------------------------------------------------------
+    // Static API
+    //------------------------------------------------------------------------
+    static Header createHeader(unsigned int numX, unsigned int numY, unsigned int numHeadings,
+                               unsigned int snapshotWidth, unsigned int snapshotHeight,
+                               float minX, float minY, float spacing);
+
+    //! Get size of file required to hold header and all snapshots
+    static size_t getFileSize(const Header &header);
+
+private:
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    const uint8_t *getSnapshot(unsigned int x, unsigned int y, unsigned int heading) const;
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    void *m_Mapping;
+    size_t m_MappingSize;
+
+    const Header *m_Header;
+    const uint8_t *m_Snapshots;
+};
@@ -0,0 +1,151 @@
+// Standard C++ includes
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Standard C includes
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// OpenCV includes
+#include <opencv2/opencv.hpp>
+
+// Common includes
+#include "../common/timer.h"
+
+// Antworld includes
+#include "common.h"
+#include "parameters.h"
+#include "snapshot_cache.h"
+#include "snapshot_processor.h"
+#include "software_renderer.h"
+
+//----------------------------------------------------------------------------
+// Anonymous namespace
+//----------------------------------------------------------------------------
+namespace
+{
+// Extent of world covered by grid
+constexpr float worldMin = 0.0f;
+constexpr float worldMax = 10.0f;
+
+// Render and process every snapshot in row y of grid into output
+void buildRow(const SoftwareRenderer &renderer, SnapshotProcessor &snapshotProcessor,
+              const SnapshotCache::Header &header, unsigned int y, uint8_t *output)
+{
+    const size_t snapshotSize = (size_t)header.snapshotWidth * header.snapshotHeight;
+
+    cv::Mat snapshot(intermediateSnapshowHeight, intermediateSnapshotWidth, CV_8UC3);
+    for(unsigned int x = 0; x < header.numX; x++) {
+        const float antX = header.minX + ((float)x * header.spacing);
+        const float antY = header.minY + ((float)y * header.spacing);
+        for(unsigned int h = 0; h < header.numHeadings; h++) {
+            renderer.render(antX, antY, (float)h * header.headingStep, snapshot);
+
+            // Process snapshot and copy into cache
+            // **NOTE** processed snapshots are continuous so can be copied in one go
+            const cv::Mat &processed = snapshotProcessor.processHost(snapshot);
+            assert(processed.isContinuous());
+            std::copy_n(processed.ptr<uint8_t>(), snapshotSize, output);
+            output += snapshotSize;
+        }
+    }
+}
+}   // Anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2) {
+        std::cerr << "Usage: snapshot_cache_builder <output filename> [grid spacing (cm)=10] [num headings=180] [num threads]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::string filename = argv[1];
+    const float spacing = ((argc > 2) ? std::stof(argv[2]) : 10.0f) / 100.0f;
+    const unsigned int numHeadings = (argc > 3) ? std::stoul(argv[3]) : 180;
+    const unsigned int numThreads = (argc > 4) ? std::stoul(argv[4]) : std::max(1u, std::thread::hardware_concurrency());
+
+    // Build header for grid
+    // **NOTE** tolerance stops e.g. 10m / 10cm rounding down to 99 intervals
+    const unsigned int numGrid = (unsigned int)std::floor(((worldMax - worldMin) / spacing) + 1.0E-3f) + 1;
+    const SnapshotCache::Header header = SnapshotCache::createHeader(numGrid, numGrid, numHeadings,
+                                                                     Parameters::inputWidth, Parameters::inputHeight,
+                                                                     worldMin, worldMin, spacing);
+    const size_t fileSize = SnapshotCache::getFileSize(header);
+    const size_t rowSize = (size_t)header.numX * header.numHeadings * header.snapshotWidth * header.snapshotHeight;
+    std::cout << "Building " << numGrid << "x" << numGrid << "x" << numHeadings << " snapshot cache (" << fileSize / (1024 * 1024) << "MiB) using " << numThreads << " threads" << std::endl;
+
+    // Load world into software renderer to render snapshots directly at intermediate resolution
+    // **NOTE** this is exactly how ant_world renders snapshots when built with SOFTWARE_RENDERER
+    const SoftwareRenderer renderer(intermediateSnapshotWidth, intermediateSnapshowHeight,
+                                    antViewHorizontalFOV, antViewVerticalFOV, antViewStartLongitude,
+                                    skyColour, "world5000_gray.bin", worldColour, groundColour);
+
+    // Create temporary file of the correct size and map it into memory
+    const std::string tempFilename = filename + "." + std::to_string(getpid()) + ".tmp";
+    const int fd = open(tempFilename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) {
+        throw std::runtime_error("Cannot create snapshot cache '" + tempFilename + "'");
+    }
+    if(ftruncate(fd, (off_t)fileSize) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot resize snapshot cache '" + tempFilename + "'");
+    }
+    void *mapping = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map snapshot cache '" + tempFilename + "'");
+    }
+
+    {
+        Timer<> timer("Building snapshot cache:");
+
+        // Write header
+        memcpy(mapping, &header, sizeof(SnapshotCache::Header));
+        uint8_t *snapshots = reinterpret_cast<uint8_t*>(mapping) + sizeof(SnapshotCache::Header);
+
+        // Launch threads which each take rows of grid until there are none left
+        // **NOTE** SnapshotProcessor isn't thread-safe so each thread needs its own
+        std::atomic<unsigned int> nextRow(0);
+        std::vector<std::thread> threads;
+        for(unsigned int t = 0; t < numThreads; t++) {
+            threads.emplace_back(
+                [&]()
+                {
+                    SnapshotProcessor snapshotProcessor(intermediateSnapshotWidth, intermediateSnapshowHeight,
+                                                        Parameters::inputWidth, Parameters::inputHeight);
+                    for(unsigned int y = nextRow++; y < header.numY; y = nextRow++) {
+                        buildRow(renderer, snapshotProcessor, header, y, snapshots + (y * rowSize));
+                        std::cout << "." << std::flush;
+                    }
+                });
+        }
+
+        for(auto &t : threads) {
+            t.join();
+        }
+        std::cout << std::endl;
+    }
+
+    // Flush to disk and rename so ant_world never sees a partially-written cache
+    msync(mapping, fileSize, MS_SYNC);
+    munmap(mapping, fileSize);
+    if(rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        remove(tempFilename.c_str());
+        throw std::runtime_error("Cannot rename snapshot cache to '" + filename + "'");
+    }
+    return EXIT_SUCCESS;
+}
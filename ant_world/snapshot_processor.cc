@@ -11,12 +11,24 @@ SnapshotProcessor::SnapshotProcessor(unsigned int intermediateWidth, unsigned in
     m_IntermediateSnapshotGreyscale(intermediateWidth, intermediateHeight, CV_8UC1),
     m_FinalSnapshot(outputWidth, outputHeight, CV_8UC1),
     m_FinalSnapshotFloat(outputWidth, outputHeight, CV_32FC1),
-    m_FinalSnapshotFloatGPU(outputWidth, outputHeight, CV_32FC1),
     m_Clahe(cv::createCLAHE(40.0, cv::Size(8, 8)))
 {
 }
 //----------------------------------------------------------------------------
 std::tuple<float*, unsigned int> SnapshotProcessor::process(const cv::Mat &snapshot)
+{
+    processHost(snapshot);
+    m_FinalSnapshot.convertTo(m_FinalSnapshotFloat, CV_32FC1, 1.0 / 255.0);
+
+    cv::imwrite("snapshot.png", m_FinalSnapshot);
+
+    // Normalise snapshot using L2 norm
+    cv::normalize(m_FinalSnapshotFloat, m_FinalSnapshotFloat);
+
+    return upload(m_FinalSnapshotFloat);
+}
+//----------------------------------------------------------------------------
+const cv::Mat &SnapshotProcessor::processHost(const cv::Mat &snapshot)
 {
     // **TODO** theoretically this processing could all be done on the GPU but
     // a) we're currently starting from a snapshot in host memory
@@ -40,15 +52,14 @@ std::tuple<float*, unsigned int> SnapshotProcessor::process(const cv::Mat &snaps
     cv::resize(m_IntermediateSnapshotGreyscale, m_FinalSnapshot,
                 cv::Size(m_OutputWidth, m_OutputHeight),
                 0.0, 0.0, CV_INTER_CUBIC);
-    m_FinalSnapshot.convertTo(m_FinalSnapshotFloat, CV_32FC1, 1.0 / 255.0);
-
-    cv::imwrite("snapshot.png", m_FinalSnapshot);
-
-    // Normalise snapshot using L2 norm
-    cv::normalize(m_FinalSnapshotFloat, m_FinalSnapshotFloat);
-
+    return m_FinalSnapshot;
+}
+//----------------------------------------------------------------------------
+std::tuple<float*, unsigned int> SnapshotProcessor::upload(const cv::Mat &snapshotFloat)
+{
     // Upload final snapshot to GPU
-    m_FinalSnapshotFloatGPU.upload(m_FinalSnapshotFloat);
+    // **NOTE** GPU memory is only allocated on first upload so processHost can be used without a GPU
+    m_FinalSnapshotFloatGPU.upload(snapshotFloat);
 
     // Extract device pointers and step; and return
     auto finalSnapshotPtrStep = (cv::cuda::PtrStep<float>)m_FinalSnapshotFloatGPU;
@@ -19,6 +19,14 @@ public:
     // and return GPU data pointer and step
     std::tuple<float*, unsigned int> process(const cv::Mat &snapshot);
 
+    // Downsample, invert and normalize histogram of input snapshot on host,
+    // returning 8-bit greyscale image at output resolution
+    const cv::Mat &processHost(const cv::Mat &snapshot);
+
+    // Upload floating point snapshot which has already been
+    // normalised and return GPU data pointer and step
+    std::tuple<float*, unsigned int> upload(const cv::Mat &snapshotFloat);
+
 private:
     //------------------------------------------------------------------------
     // Private members
@@ -0,0 +1,278 @@
+#include "software_renderer.h"
+
+// Standard C++ includes
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+// Standard C includes
+#include <cmath>
+
+// Antworld includes
+#include "common.h"
+#include "world_mesh.h"
+
+//----------------------------------------------------------------------------
+// Anonymous namespace
+//----------------------------------------------------------------------------
+namespace
+{
+// Height of ant's eye and far clipping plane used by renderAntView
+constexpr float eyeHeight = 0.01f;
+constexpr float farPlane = 14.0f;
+
+// Padding applied to angular bounds of triangles to absorb rounding (degrees)
+constexpr float boundsPadding = 1.0E-3f;
+
+uint8_t toUnorm8(float colour)
+{
+    return (uint8_t)std::round(std::min(1.0f, std::max(0.0f, colour)) * 255.0f);
+}
+//----------------------------------------------------------------------------
+float cross2D(float ax, float ay, float bx, float by)
+{
+    return (ax * by) - (ay * bx);
+}
+//----------------------------------------------------------------------------
+// Distance from origin to 2D line segment between a and b
+float getDistanceToSegment(float ax, float ay, float bx, float by)
+{
+    const float dx = bx - ax;
+    const float dy = by - ay;
+    const float lengthSquared = (dx * dx) + (dy * dy);
+    const float t = (lengthSquared > 0.0f) ? std::min(1.0f, std::max(0.0f, -((ax * dx) + (ay * dy)) / lengthSquared)) : 0.0f;
+    return std::hypot(ax + (t * dx), ay + (t * dy));
+}
+//----------------------------------------------------------------------------
+// Wrap angle into [-180, 180) degrees
+float wrapDegrees(float angle)
+{
+    return angle - (360.0f * std::floor((angle + 180.0f) / 360.0f));
+}
+//----------------------------------------------------------------------------
+// Get range of pixels whose centres (start + ((i + 0.5) * step)) lie within [lo, hi]
+void getPixelRange(float lo, float hi, float start, float step, unsigned int numPixels, int &first, int &last)
+{
+    // If step is negative, pixel order is reversed
+    const float a = ((step > 0.0f ? lo : hi) - start) / step;
+    const float b = ((step > 0.0f ? hi : lo) - start) / step;
+    first = std::max(0, (int)std::ceil(a - 0.5f));
+    last = std::min((int)numPixels - 1, (int)std::floor(b - 0.5f));
+}
+}   // Anonymous namespace
+
+//----------------------------------------------------------------------------
+// SoftwareRenderer
+//----------------------------------------------------------------------------
+SoftwareRenderer::SoftwareRenderer(unsigned int width, unsigned int height,
+                                   float horizontalFOV, float verticalFOV, float startLongitude,
+                                   const float (&skyColour)[3])
+:   m_Width(width), m_Height(height),
+    m_StartAzimuth(-horizontalFOV / 2.0f), m_AzimuthStep(horizontalFOV / (float)width),
+    m_StartElevation(-startLongitude), m_ElevationStep(verticalFOV / (float)height)
+{
+    // Store sky colour in BGR order to match glReadPixels snapshots
+    m_SkyColour[0] = toUnorm8(skyColour[2]);
+    m_SkyColour[1] = toUnorm8(skyColour[1]);
+    m_SkyColour[2] = toUnorm8(skyColour[0]);
+
+    // **NOTE** RenderMesh's longitude is measured downwards from the horizon
+    for(unsigned int i = 0; i < width; i++) {
+        const float azimuth = m_StartAzimuth + (((float)i + 0.5f) * m_AzimuthStep);
+        m_SinAzimuth.push_back(sin(azimuth * degreesToRadians));
+        m_CosAzimuth.push_back(cos(azimuth * degreesToRadians));
+    }
+    for(unsigned int j = 0; j < height; j++) {
+        const float elevation = m_StartElevation + (((float)j + 0.5f) * m_ElevationStep);
+        m_SinElevation.push_back(sin(elevation * degreesToRadians));
+        m_CosElevation.push_back(cos(elevation * degreesToRadians));
+    }
+}
+//----------------------------------------------------------------------------
+SoftwareRenderer::SoftwareRenderer(unsigned int width, unsigned int height,
+                                   float horizontalFOV, float verticalFOV, float startLongitude,
+                                   const float (&skyColour)[3], const std::string &filename,
+                                   const float (&worldColour)[3], const float (&groundColour)[3])
+:   SoftwareRenderer(width, height, horizontalFOV, verticalFOV, startLongitude, skyColour)
+{
+    if(!load(filename, worldColour, groundColour)) {
+        throw std::runtime_error("Cannot load world");
+    }
+}
+//----------------------------------------------------------------------------
+bool SoftwareRenderer::load(const std::string &filename, const float (&worldColour)[3],
+                            const float (&groundColour)[3])
+{
+    // Map compact mesh if available, otherwise load legacy file
+    WorldMesh mesh;
+    if(!mesh.load(filename, worldColour, groundColour)) {
+        return false;
+    }
+
+    // Add triangles, including ground
+    // **NOTE** all vertices of a triangle share a colour
+    const size_t numTriangles = mesh.getNumVertices() / 3;
+    const WorldMesh::Vertex *vertices = mesh.getVertices();
+    m_Triangles.clear();
+    m_Triangles.reserve(numTriangles);
+    for(size_t t = 0; t < numTriangles; t++) {
+        const WorldMesh::Vertex *v = &vertices[t * 3];
+        addTriangle({{v[0].position[0], v[0].position[1], v[0].position[2]},
+                     {v[1].position[0], v[1].position[1], v[1].position[2]},
+                     {v[2].position[0], v[2].position[1], v[2].position[2]}},
+                    v[0].colour);
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------------
+void SoftwareRenderer::render(float antX, float antY, float antHeading, cv::Mat &output) const
+{
+    output.create(m_Height, m_Width, CV_8UC3);
+
+    // Clear to sky
+    const unsigned int numPixels = m_Width * m_Height;
+    uint8_t *pixels = output.ptr<uint8_t>(0);
+    for(unsigned int p = 0; p < numPixels; p++) {
+        std::copy(&m_SkyColour[0], &m_SkyColour[3], &pixels[p * 3]);
+    }
+
+    // Initialise depth buffer to far plane
+    // **NOTE** renderAntView clips against the far plane of each cube face so distance depends on direction
+    std::vector<float> depth(numPixels);
+    for(unsigned int j = 0; j < m_Height; j++) {
+        for(unsigned int i = 0; i < m_Width; i++) {
+            const float major = std::max(std::fabs(m_SinElevation[j]),
+                                         m_CosElevation[j] * std::max(std::fabs(m_SinAzimuth[i]), std::fabs(m_CosAzimuth[i])));
+            depth[(j * m_Width) + i] = farPlane / major;
+        }
+    }
+
+    // Rotate column directions by heading
+    // **NOTE** headings are clockwise from +y so direction is (sin, cos)
+    const float sinHeading = sin(antHeading * degreesToRadians);
+    const float cosHeading = cos(antHeading * degreesToRadians);
+    std::vector<float> columnX(m_Width);
+    std::vector<float> columnY(m_Width);
+    for(unsigned int i = 0; i < m_Width; i++) {
+        columnX[i] = (sinHeading * m_CosAzimuth[i]) + (cosHeading * m_SinAzimuth[i]);
+        columnY[i] = (cosHeading * m_CosAzimuth[i]) - (sinHeading * m_SinAzimuth[i]);
+    }
+
+    const float eye[3] = {antX, antY, eyeHeight};
+    for(const auto &tri : m_Triangles) {
+        // Get vertices relative to eye
+        float p[3][3];
+        for(unsigned int v = 0; v < 3; v++) {
+            for(unsigned int c = 0; c < 3; c++) {
+                p[v][c] = tri.vertices[v][c] - eye[c];
+            }
+        }
+
+        // Get horizontal distance from eye to triangle, which is zero if eye is above or below it
+        const float area = cross2D(p[1][0] - p[0][0], p[1][1] - p[0][1], p[2][0] - p[0][0], p[2][1] - p[0][1]);
+        const float w0 = cross2D(p[1][0], p[1][1], p[2][0], p[2][1]);
+        const float w1 = cross2D(p[2][0], p[2][1], p[0][0], p[0][1]);
+        const float w2 = cross2D(p[0][0], p[0][1], p[1][0], p[1][1]);
+        const bool inside = (area != 0.0f) && ((area > 0.0f) ? (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f)
+                                                              : (w0 <= 0.0f && w1 <= 0.0f && w2 <= 0.0f));
+        const float minDistance = inside ? 0.0f : std::min({getDistanceToSegment(p[0][0], p[0][1], p[1][0], p[1][1]),
+                                                            getDistanceToSegment(p[1][0], p[1][1], p[2][0], p[2][1]),
+                                                            getDistanceToSegment(p[2][0], p[2][1], p[0][0], p[0][1])});
+        const float maxDistance = std::max({std::hypot(p[0][0], p[0][1]), std::hypot(p[1][0], p[1][1]),
+                                            std::hypot(p[2][0], p[2][1])});
+
+        // Bound elevation of triangle - highest point can be no higher than its
+        // highest vertex at the closest horizontal distance and vice-versa
+        const float minZ = std::min({p[0][2], p[1][2], p[2][2]});
+        const float maxZ = std::max({p[0][2], p[1][2], p[2][2]});
+        const float maxElevation = atan2(maxZ, (maxZ > 0.0f) ? minDistance : maxDistance) * radiansToDegrees;
+        const float minElevation = atan2(minZ, (minZ < 0.0f) ? minDistance : maxDistance) * radiansToDegrees;
+
+        int firstRow;
+        int lastRow;
+        getPixelRange(minElevation - boundsPadding, maxElevation + boundsPadding,
+                      m_StartElevation, m_ElevationStep, m_Height, firstRow, lastRow);
+        if(firstRow > lastRow) {
+            continue;
+        }
+
+        // If eye is outside triangle, it subtends less than 180 degrees so bound
+        // azimuth by its vertices, relative to heading. Otherwise it surrounds us
+        float minAzimuth = -180.0f;
+        float maxAzimuth = 180.0f;
+        if(minDistance > 0.0f) {
+            const float a0 = wrapDegrees((atan2(p[0][0], p[0][1]) * radiansToDegrees) - antHeading);
+            const float d1 = wrapDegrees((atan2(p[1][0], p[1][1]) * radiansToDegrees) - antHeading - a0);
+            const float d2 = wrapDegrees((atan2(p[2][0], p[2][1]) * radiansToDegrees) - antHeading - a0);
+            minAzimuth = a0 + std::min({0.0f, d1, d2}) - boundsPadding;
+            maxAzimuth = a0 + std::max({0.0f, d1, d2}) + boundsPadding;
+        }
+
+        // Calculate parts of intersection test which don't depend on ray direction
+        const float *e1 = tri.edges[0];
+        const float *e2 = tri.edges[1];
+        const float s[3] = {-p[0][0], -p[0][1], -p[0][2]};
+        const float q[3] = {(s[1] * e1[2]) - (s[2] * e1[1]), (s[2] * e1[0]) - (s[0] * e1[2]), (s[0] * e1[1]) - (s[1] * e1[0])};
+        const float qe2 = (q[0] * e2[0]) + (q[1] * e2[1]) + (q[2] * e2[2]);
+
+        // Loop through copies of azimuth range either side of wrap-around
+        for(float offset : {-360.0f, 0.0f, 360.0f}) {
+            int firstColumn;
+            int lastColumn;
+            getPixelRange(minAzimuth + offset, maxAzimuth + offset,
+                          m_StartAzimuth, m_AzimuthStep, m_Width, firstColumn, lastColumn);
+
+            for(int j = firstRow; j <= lastRow; j++) {
+                const float dirZ = m_SinElevation[j];
+                for(int i = firstColumn; i <= lastColumn; i++) {
+                    const float dir[3] = {m_CosElevation[j] * columnX[i], m_CosElevation[j] * columnY[i], dirZ};
+
+                    // Moller-Trumbore ray-triangle intersection
+                    const float r[3] = {(dir[1] * e2[2]) - (dir[2] * e2[1]), (dir[2] * e2[0]) - (dir[0] * e2[2]),
+                                        (dir[0] * e2[1]) - (dir[1] * e2[0])};
+                    const float det = (e1[0] * r[0]) + (e1[1] * r[1]) + (e1[2] * r[2]);
+                    if(std::fabs(det) < 1.0E-12f) {
+                        continue;
+                    }
+
+                    const float invDet = 1.0f / det;
+                    const float u = ((s[0] * r[0]) + (s[1] * r[1]) + (s[2] * r[2])) * invDet;
+                    if(u < 0.0f || u > 1.0f) {
+                        continue;
+                    }
+                    const float v = ((dir[0] * q[0]) + (dir[1] * q[1]) + (dir[2] * q[2])) * invDet;
+                    if(v < 0.0f || (u + v) > 1.0f) {
+                        continue;
+                    }
+
+                    // If intersection is in front of eye and nearer than current depth, draw
+                    const float t = qe2 * invDet;
+                    const unsigned int pixel = (j * m_Width) + i;
+                    if(t > 0.0f && t < depth[pixel]) {
+                        depth[pixel] = t;
+                        std::copy(&tri.colour[0], &tri.colour[3], &pixels[pixel * 3]);
+                    }
+                }
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------
+void SoftwareRenderer::addTriangle(const float (&vertices)[3][3], const float (&colour)[3])
+{
+    Triangle tri;
+    for(unsigned int c = 0; c < 3; c++) {
+        tri.vertices[0][c] = vertices[0][c];
+        tri.vertices[1][c] = vertices[1][c];
+        tri.vertices[2][c] = vertices[2][c];
+        tri.edges[0][c] = vertices[1][c] - vertices[0][c];
+        tri.edges[1][c] = vertices[2][c] - vertices[0][c];
+    }
+
+    // Store colour in BGR order to match glReadPixels snapshots
+    tri.colour[0] = toUnorm8(colour[2]);
+    tri.colour[1] = toUnorm8(colour[1]);
+    tri.colour[2] = toUnorm8(colour[0]);
+    m_Triangles.push_back(tri);
+}
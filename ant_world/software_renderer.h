@@ -0,0 +1,82 @@
+#pragma once
+
+// Standard C++ includes
+#include <string>
+#include <vector>
+
+// Standard C includes
+#include <cstdint>
+
+// OpenCV includes
+#include <opencv2/opencv.hpp>
+
+//----------------------------------------------------------------------------
+// SoftwareRenderer
+//----------------------------------------------------------------------------
+//! CPU rasteriser which renders the world directly into an equirectangular
+//! panorama, without needing an OpenGL context. Each triangle's angular
+//! bounds are rasterised into a z-buffered panorama with an exact ray test
+//! per pixel so the result matches what renderAntView produces via the
+//! cubemap and RenderMesh, sampled at the resolution of the output.
+//! render is const so one renderer can be shared between threads.
+class SoftwareRenderer
+{
+public:
+    SoftwareRenderer(unsigned int width, unsigned int height,
+                     float horizontalFOV, float verticalFOV, float startLongitude,
+                     const float (&skyColour)[3]);
+    SoftwareRenderer(unsigned int width, unsigned int height,
+                     float horizontalFOV, float verticalFOV, float startLongitude,
+                     const float (&skyColour)[3], const std::string &filename,
+                     const float (&worldColour)[3], const float (&groundColour)[3]);
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    bool load(const std::string &filename, const float (&worldColour)[3],
+              const float (&groundColour)[3]);
+
+    //! Render view from ant's position into output as 8-bit BGR. Like the
+    //! result of glReadPixels, row 0 is the bottom of the view (startLongitude)
+    void render(float antX, float antY, float antHeading, cv::Mat &output) const;
+
+    size_t getNumTriangles() const{ return m_Triangles.size(); }
+
+private:
+    //------------------------------------------------------------------------
+    // Triangle
+    //------------------------------------------------------------------------
+    struct Triangle
+    {
+        float vertices[3][3];
+        float edges[2][3];
+        uint8_t colour[3];
+    };
+
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    void addTriangle(const float (&vertices)[3][3], const float (&colour)[3]);
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const unsigned int m_Width;
+    const unsigned int m_Height;
+
+    // Azimuth of first column and elevation of first row (degrees, up is positive) and step between them
+    const float m_StartAzimuth;
+    const float m_AzimuthStep;
+    const float m_StartElevation;
+    const float m_ElevationStep;
+
+    uint8_t m_SkyColour[3];
+
+    // Sin and cos of each column's azimuth relative to heading and each row's elevation
+    std::vector<float> m_SinAzimuth;
+    std::vector<float> m_CosAzimuth;
+    std::vector<float> m_SinElevation;
+    std::vector<float> m_CosElevation;
+
+    std::vector<Triangle> m_Triangles;
+};
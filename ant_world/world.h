@@ -31,7 +31,6 @@ private:
     // Members
     //------------------------------------------------------------------------
     GLuint m_VAO;
-    GLuint m_PositionVBO;
-    GLuint m_ColourVBO;
+    GLuint m_VBO;
     unsigned int m_NumVertices;
 };
\ No newline at end of file
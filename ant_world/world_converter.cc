@@ -0,0 +1,45 @@
+// Standard C++ includes
+#include <iostream>
+#include <string>
+
+// Standard C includes
+#include <cstdlib>
+
+// Common includes
+#include "../common/timer.h"
+
+// Antworld includes
+#include "common.h"
+#include "world_mesh.h"
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2) {
+        std::cerr << "Usage: world_converter <legacy world .bin> [output .mesh]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // By default, write mesh where World::load will look for it
+    const std::string inputFilename = argv[1];
+    const std::string outputFilename = (argc > 2) ? argv[2] : WorldMesh::getMeshFilename(inputFilename);
+
+    // Load legacy world, baking in the colours ant_world uses
+    WorldMesh mesh;
+    {
+        Timer<> timer("Loading legacy world:");
+        if(!mesh.loadLegacy(inputFilename, worldColour, groundColour)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Write compact mesh
+    {
+        Timer<> timer("Writing mesh:");
+        if(!mesh.save(outputFilename)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << "Wrote " << mesh.getNumVertices() << " vertices to '" << outputFilename << "'" << std::endl;
+    return EXIT_SUCCESS;
+}
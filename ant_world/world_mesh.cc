@@ -0,0 +1,213 @@
+#include "world_mesh.h"
+
+// Standard C++ includes
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+// Standard C includes
+#include <cstdio>
+#include <cstring>
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//----------------------------------------------------------------------------
+// Anonymous namespace
+//----------------------------------------------------------------------------
+namespace
+{
+const char magic[8] = {'A', 'N', 'T', 'W', 'O', 'R', 'L', 'D'};
+const uint32_t version = 1;
+
+static_assert(sizeof(WorldMesh::Header) == 48, "World mesh header should be tightly packed");
+static_assert(sizeof(WorldMesh::Vertex) == 24, "World mesh vertices should be tightly packed");
+
+bool coloursMatch(const float (&a)[3], const float (&b)[3])
+{
+    return std::equal(&a[0], &a[3], &b[0]);
+}
+}   // Anonymous namespace
+
+//----------------------------------------------------------------------------
+// WorldMesh
+//----------------------------------------------------------------------------
+WorldMesh::WorldMesh() : m_Mapping(nullptr), m_MappingSize(0), m_Vertices(nullptr), m_NumVertices(0)
+{
+}
+//----------------------------------------------------------------------------
+WorldMesh::~WorldMesh()
+{
+    clear();
+}
+//----------------------------------------------------------------------------
+bool WorldMesh::load(const std::string &filename, const float (&worldColour)[3], const float (&groundColour)[3])
+{
+    return map(getMeshFilename(filename), worldColour, groundColour)
+        || loadLegacy(filename, worldColour, groundColour);
+}
+//----------------------------------------------------------------------------
+bool WorldMesh::map(const std::string &filename, const float (&worldColour)[3], const float (&groundColour)[3])
+{
+    clear();
+
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+
+    // Get file size and check it's large enough to contain a header
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || (size_t)fileStat.st_size < sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+
+    // Map file into memory
+    m_MappingSize = (size_t)fileStat.st_size;
+    m_Mapping = mmap(nullptr, m_MappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(m_Mapping == MAP_FAILED) {
+        m_Mapping = nullptr;
+        return false;
+    }
+
+    // **NOTE** the whole file is going to be read straight away so start reading it in
+    madvise(m_Mapping, m_MappingSize, MADV_WILLNEED);
+
+    // Check header, colours and size
+    const Header *header = reinterpret_cast<const Header*>(m_Mapping);
+    if(memcmp(header->magic, magic, sizeof(magic)) != 0 || header->version != version
+        || !coloursMatch(header->worldColour, worldColour) || !coloursMatch(header->groundColour, groundColour)
+        || m_MappingSize != (sizeof(Header) + (header->numVertices * sizeof(Vertex))))
+    {
+        std::cerr << "World mesh '" << filename << "' doesn't match - ignoring" << std::endl;
+        clear();
+        return false;
+    }
+
+    m_Vertices = reinterpret_cast<const Vertex*>(header + 1);
+    m_NumVertices = header->numVertices;
+    std::copy(&worldColour[0], &worldColour[3], &m_WorldColour[0]);
+    std::copy(&groundColour[0], &groundColour[3], &m_GroundColour[0]);
+    std::cout << "World has " << (m_NumVertices / 3) - 2 << " triangles" << std::endl;
+    return true;
+}
+//----------------------------------------------------------------------------
+bool WorldMesh::loadLegacy(const std::string &filename, const float (&worldColour)[3], const float (&groundColour)[3])
+{
+    clear();
+
+    // Open file for binary IO
+    std::ifstream input(filename, std::ios::binary);
+    if(!input.good()) {
+        std::cerr << "Cannot open world file:" << filename << std::endl;
+        return false;
+    }
+
+    // Read whole file
+    // **NOTE** positions are stored component-major then vertex-major, followed by RGB colours
+    input.seekg(0, std::ios_base::end);
+    const size_t numTriangles = input.tellg() / (sizeof(double) * 12);
+    std::vector<double> data(numTriangles * 12);
+    input.seekg(0);
+    input.read(reinterpret_cast<char*>(data.data()), data.size() * sizeof(double));
+    std::cout << "World has " << numTriangles << " triangles" << std::endl;
+
+    // Add ground triangles
+    m_LegacyVertices.reserve((numTriangles + 2) * 3);
+    const float groundPositions[6][3] = {{0.0f, 0.0f, 0.0f}, {10.5f, 10.5f, 0.0f}, {0.0f, 10.5f, 0.0f},
+                                         {0.0f, 0.0f, 0.0f}, {10.5f, 0.0f, 0.0f}, {10.5f, 10.5f, 0.0f}};
+    for(const auto &p : groundPositions) {
+        m_LegacyVertices.push_back({{p[0], p[1], p[2]}, {groundColour[0], groundColour[1], groundColour[2]}});
+    }
+
+    // Add world triangles
+    for(size_t t = 0; t < numTriangles; t++) {
+        // **NOTE** we only bother reading the R channel because colours are greyscale anyway
+        const float triangleColour = (float)data[(9 * numTriangles) + t];
+
+        // Loop through vertices that make up triangle and
+        // set to world colour multiplied by triangle colour
+        for(unsigned int v = 0; v < 3; v++) {
+            m_LegacyVertices.push_back({{(float)data[(v * numTriangles) + t],
+                                         (float)data[((3 + v) * numTriangles) + t],
+                                         (float)data[((6 + v) * numTriangles) + t]},
+                                        {worldColour[0] * triangleColour, worldColour[1] * triangleColour,
+                                         worldColour[2] * triangleColour}});
+        }
+    }
+
+    m_Vertices = m_LegacyVertices.data();
+    m_NumVertices = m_LegacyVertices.size();
+    std::copy(&worldColour[0], &worldColour[3], &m_WorldColour[0]);
+    std::copy(&groundColour[0], &groundColour[3], &m_GroundColour[0]);
+    return true;
+}
+//----------------------------------------------------------------------------
+bool WorldMesh::save(const std::string &filename) const
+{
+    // **NOTE** zero so padding is deterministic
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.numVertices = m_NumVertices;
+    std::copy(&m_WorldColour[0], &m_WorldColour[3], &header.worldColour[0]);
+    std::copy(&m_GroundColour[0], &m_GroundColour[3], &header.groundColour[0]);
+
+    // Write to a temporary file and then rename it so a partially-written mesh is never mapped
+    const std::string tempFilename = filename + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream output(tempFilename, std::ios::binary);
+        if(!output.good()) {
+            std::cerr << "Cannot write world mesh file '" << tempFilename << "'" << std::endl;
+            return false;
+        }
+
+        output.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        output.write(reinterpret_cast<const char*>(m_Vertices), m_NumVertices * sizeof(Vertex));
+        if(!output.good()) {
+            std::cerr << "Cannot write world mesh file '" << tempFilename << "'" << std::endl;
+            output.close();
+            remove(tempFilename.c_str());
+            return false;
+        }
+    }
+
+    if(rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Cannot rename world mesh file to '" << filename << "'" << std::endl;
+        remove(tempFilename.c_str());
+        return false;
+    }
+    return true;
+}
+//----------------------------------------------------------------------------
+std::string WorldMesh::getMeshFilename(const std::string &filename)
+{
+    // Replace .bin extension (if present) with .mesh
+    const size_t extension = filename.rfind(".bin");
+    if(extension != std::string::npos && extension == (filename.size() - 4)) {
+        return filename.substr(0, extension) + ".mesh";
+    }
+    else {
+        return filename + ".mesh";
+    }
+}
+//----------------------------------------------------------------------------
+void WorldMesh::clear()
+{
+    if(m_Mapping != nullptr) {
+        munmap(m_Mapping, m_MappingSize);
+        m_Mapping = nullptr;
+        m_MappingSize = 0;
+    }
+
+    // **NOTE** swap to actually free memory
+    std::vector<Vertex>().swap(m_LegacyVertices);
+    m_Vertices = nullptr;
+    m_NumVertices = 0;
+}
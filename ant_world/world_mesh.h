@@ -0,0 +1,98 @@
+#pragma once
+
+// Standard C++ includes
+#include <string>
+#include <vector>
+
+// Standard C includes
+#include <cstddef>
+#include <cstdint>
+
+//----------------------------------------------------------------------------
+// WorldMesh
+//----------------------------------------------------------------------------
+//! Triangle soup of world, including the ground, as interleaved float32
+//! position and colour vertices which can be passed straight to glBufferData
+//! or the SoftwareRenderer. Meshes are either memory-mapped from a file in
+//! the compact format written by save (see world_converter) or, as a
+//! fallback, built from the legacy component-major .bin format
+class WorldMesh
+{
+public:
+    //------------------------------------------------------------------------
+    // Vertex
+    //------------------------------------------------------------------------
+    struct Vertex
+    {
+        float position[3];
+        float colour[3];
+    };
+
+    //------------------------------------------------------------------------
+    // Header
+    //------------------------------------------------------------------------
+    //! Header at the start of each mesh file, followed by numVertices vertices.
+    //! Colours used to build the mesh are stored so stale files can be detected
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t padding;
+        uint64_t numVertices;
+        float worldColour[3];
+        float groundColour[3];
+    };
+
+    WorldMesh();
+    ~WorldMesh();
+
+    WorldMesh(const WorldMesh&) = delete;
+    WorldMesh &operator=(const WorldMesh&) = delete;
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Map compact mesh corresponding to legacy .bin file if there is one
+    //! built with the same colours, otherwise load legacy file
+    bool load(const std::string &filename, const float (&worldColour)[3], const float (&groundColour)[3]);
+
+    //! Memory-map mesh file written by save, returning false if it's missing or was built with different colours
+    bool map(const std::string &filename, const float (&worldColour)[3], const float (&groundColour)[3]);
+
+    //! Load mesh from legacy .bin file and add ground
+    bool loadLegacy(const std::string &filename, const float (&worldColour)[3], const float (&groundColour)[3]);
+
+    //! Write mesh in compact format
+    bool save(const std::string &filename) const;
+
+    const Vertex *getVertices() const{ return m_Vertices; }
+    size_t getNumVertices() const{ return m_NumVertices; }
+
+    //------------------------------------------------------------------------
+    // Static API
+    //------------------------------------------------------------------------
+    //! Get filename of compact mesh corresponding to legacy .bin file
+    static std::string getMeshFilename(const std::string &filename);
+
+private:
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    void clear();
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    // Memory mapping if mesh was mapped from file
+    void *m_Mapping;
+    size_t m_MappingSize;
+
+    // Vertices if mesh was loaded from legacy file
+    std::vector<Vertex> m_LegacyVertices;
+
+    const Vertex *m_Vertices;
+    size_t m_NumVertices;
+
+    float m_WorldColour[3];
+    float m_GroundColour[3];
+};
@@ -21,27 +21,34 @@ def get_csv_columns(csv_file, headers=True):
     # Read columns and return
     return zip(*reader)
 
-with open("pn_spikes.csv", "rb") as pn_spikes_file, \
-     open("kc_spikes.csv", "rb") as kc_spikes_file, \
-     open("en_spikes.csv", "rb") as en_spikes_file, \
-     open("kc_en_syn.csv", "rb") as kc_en_syn_file:
-
-    # Read data and zip into columns
-    pn_spikes_columns = get_csv_columns(pn_spikes_file)
-    kc_spikes_columns = get_csv_columns(kc_spikes_file)
-    en_spikes_columns = get_csv_columns(en_spikes_file)
+def read_spikes(filename):
+    # Read spikes written by SpikeBinaryRecorder: 8 byte magic followed, for each timestep
+    # with spikes, by a double time, a uint32 spike count and that many uint32 neuron IDs
+    with open(filename, "rb") as spikes_file:
+        data = spikes_file.read()
+    assert data[:8] == b"GENNSPK1", "%s is not a binary spike file" % filename
+
+    times = [np.empty(0)]
+    ids = [np.empty(0, dtype=np.uint32)]
+    offset = 8
+    while (offset + 12) <= len(data):
+        time = np.frombuffer(data, dtype="<f8", count=1, offset=offset)[0]
+        count = np.frombuffer(data, dtype="<u4", count=1, offset=offset + 8)[0]
+        ids.append(np.frombuffer(data, dtype="<u4", count=count, offset=offset + 12))
+        times.append(np.repeat(time, count))
+        offset += 12 + (4 * count)
+
+    return np.concatenate(times), np.concatenate(ids).astype(int)
+
+with open("kc_en_syn.csv", "rb") as kc_en_syn_file:
+    # Read spikes
+    pn_spike_times, pn_spike_neuron_id = read_spikes("pn_spikes.bin")
+    kc_spike_times, kc_spike_neuron_id = read_spikes("kc_spikes.bin")
+    en_spike_times, en_spike_neuron_id = read_spikes("en_spikes.bin")
 
     if plot_synapse:
         kc_en_syn_columns = get_csv_columns(kc_en_syn_file, False)
 
-    # Convert CSV columns to numpy
-    pn_spike_times = np.asarray(pn_spikes_columns[0], dtype=float)
-    pn_spike_neuron_id = np.asarray(pn_spikes_columns[1], dtype=int)
-    kc_spike_times = np.asarray(kc_spikes_columns[0], dtype=float)
-    kc_spike_neuron_id = np.asarray(kc_spikes_columns[1], dtype=int)
-    en_spike_times = np.asarray(en_spikes_columns[0], dtype=float)
-    en_spike_neuron_id = np.asarray(en_spikes_columns[1], dtype=int)
-
     if plot_synapse:
         kc_en_tag = np.asarray(kc_en_syn_columns[2], dtype=float)
         kc_en_weight = np.asarray(kc_en_syn_columns[3], dtype=float)
@@ -18,7 +18,7 @@ extern "C"
 // Common includes
 #include "../common/connectors.h"
 #include "../common/png_to_float.h"
-#include "../common/spike_csv_recorder.h"
+#include "../common/spike_binary_recorder.h"
 #include "../common/timer.h"
 
 // GeNN generated code includes
@@ -135,10 +135,11 @@ int main()
 
     dkcToEN = 0.0f;
 
-    // Open CSV output files
-    SpikeCSVRecorder pnSpikes("pn_spikes.csv", glbSpkCntPN, glbSpkPN);
-    SpikeCSVRecorder kcSpikes("kc_spikes.csv", glbSpkCntKC, glbSpkKC);
-    SpikeCSVRecorder enSpikes("en_spikes.csv", glbSpkCntEN, glbSpkEN);
+    // Open binary spike output files
+    // **NOTE** convert to CSV for plotting with common/spike_binary_to_csv.py
+    SpikeBinaryRecorder pnSpikes("pn_spikes.bin", glbSpkCntPN, glbSpkPN);
+    SpikeBinaryRecorder kcSpikes("kc_spikes.bin", glbSpkCntKC, glbSpkKC);
+    SpikeBinaryRecorder enSpikes("en_spikes.bin", glbSpkCntEN, glbSpkEN);
 
 #ifdef RECORD_SYNAPSE_STATE
     std::ofstream synapticTagStream("kc_en_syn.csv");
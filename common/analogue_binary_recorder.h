@@ -0,0 +1,186 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+// Standard C includes
+#include <cstdint>
+#include <cstring>
+
+// Common includes
+#include "background_file_writer.h"
+
+//----------------------------------------------------------------------------
+// AnalogueBinaryRecorder
+//----------------------------------------------------------------------------
+//! Records a state variable from a (subset of a) population in a binary file
+//! via a BackgroundFileWriter. After a header, each record is one row holding
+//! the time followed by a column per recorded neuron so the file can be
+//! loaded into a numpy structured array with numpy.fromfile. The header is:
+//!     char[8] magic "GENNANA1"
+//!     uint32 number of recorded neurons
+//!     uint32 size of T in bytes
+//!     uint32 interval between records (in calls to record)
+//!     uint32 mode (0 = raw, 1 = summary)
+//!     uint32[number of recorded neurons] neuron IDs
+//! In Raw mode, each record contains a double time and the value of each
+//! neuron. In Summary mode, each record contains a double time (of the end
+//! of the window) and then the min, max and mean of each neuron over the window.
+//! If recording stops part way through a window, the partial window is written
+//! when the recorder is destroyed with the mean taken over the samples recorded
+template<typename T>
+class AnalogueBinaryRecorder
+{
+public:
+    //------------------------------------------------------------------------
+    // Enumerations
+    //------------------------------------------------------------------------
+    enum class Mode : uint32_t
+    {
+        Raw,
+        Summary,
+    };
+
+    AnalogueBinaryRecorder(const char *filename, T *variable, unsigned int popSize,
+                           unsigned int interval = 1, Mode mode = Mode::Raw,
+                           const std::vector<unsigned int> &neurons = {},
+                           size_t bufferBytes = 1024 * 1024)
+    :   m_Writer(filename, bufferBytes), m_Variable(variable), m_Neurons(neurons),
+        m_Interval(std::max(1u, interval)), m_Mode(mode), m_Step(0), m_WindowSamples(0), m_WindowEndTime(0.0)
+    {
+        // If no subset of neurons is specified, record all
+        const bool allNeurons = m_Neurons.empty();
+        if(allNeurons) {
+            m_Neurons.resize(popSize);
+            for(unsigned int i = 0; i < popSize; i++) {
+                m_Neurons[i] = i;
+            }
+        }
+
+        // Only use gather when recording a subset
+        m_Gather = !allNeurons;
+
+        // Write header
+        const uint32_t header[4] = {(uint32_t)m_Neurons.size(), sizeof(T), m_Interval, (uint32_t)m_Mode};
+        m_Writer.write("GENNANA1", 8);
+        m_Writer.write(header, sizeof(header));
+        m_Writer.write(m_Neurons.data(), sizeof(uint32_t) * m_Neurons.size());
+
+        // Allocate summary accumulators
+        if(m_Mode == Mode::Summary) {
+            m_Min.resize(m_Neurons.size());
+            m_Max.resize(m_Neurons.size());
+            m_Sum.resize(m_Neurons.size());
+            resetSummary();
+        }
+    }
+
+    ~AnalogueBinaryRecorder()
+    {
+        // Write any partial window
+        // **NOTE** m_Writer is destroyed after this so will flush it to disk
+        if(m_Mode == Mode::Summary && m_WindowSamples > 0) {
+            writeSummary();
+        }
+    }
+
+    void record(double t)
+    {
+        const size_t numNeurons = m_Neurons.size();
+
+        if(m_Mode == Mode::Raw) {
+            // If this is a timestep to record
+            if((m_Step % m_Interval) == 0) {
+                // Reserve space for time and row of values
+                char *data = m_Writer.reserve(sizeof(double) + (sizeof(T) * numNeurons));
+                std::memcpy(data, &t, sizeof(double));
+                T *values = reinterpret_cast<T*>(data + sizeof(double));
+
+                // Copy values
+                if(m_Gather) {
+                    for(size_t n = 0; n < numNeurons; n++) {
+                        std::memcpy(&values[n], &m_Variable[m_Neurons[n]], sizeof(T));
+                    }
+                }
+                else {
+                    std::memcpy(values, m_Variable, sizeof(T) * numNeurons);
+                }
+            }
+        }
+        else {
+            // Update summary statistics
+            for(size_t n = 0; n < numNeurons; n++) {
+                const T v = m_Variable[m_Neurons[n]];
+                m_Min[n] = std::min(m_Min[n], v);
+                m_Max[n] = std::max(m_Max[n], v);
+                m_Sum[n] += (double)v;
+            }
+            m_WindowSamples++;
+            m_WindowEndTime = t;
+
+            // If this is the end of a window, write summary
+            if(((m_Step + 1) % m_Interval) == 0) {
+                writeSummary();
+            }
+        }
+
+        m_Step++;
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    //! Write min, max and mean of current window and reset
+    void writeSummary()
+    {
+        const size_t numNeurons = m_Neurons.size();
+        char *data = m_Writer.reserve(sizeof(double) + (3 * sizeof(T) * numNeurons));
+        std::memcpy(data, &m_WindowEndTime, sizeof(double));
+        data += sizeof(double);
+
+        std::memcpy(data, m_Min.data(), sizeof(T) * numNeurons);
+        data += sizeof(T) * numNeurons;
+
+        std::memcpy(data, m_Max.data(), sizeof(T) * numNeurons);
+        data += sizeof(T) * numNeurons;
+
+        for(size_t n = 0; n < numNeurons; n++) {
+            const T mean = (T)(m_Sum[n] / (double)m_WindowSamples);
+            std::memcpy(data + (n * sizeof(T)), &mean, sizeof(T));
+        }
+
+        resetSummary();
+    }
+
+    void resetSummary()
+    {
+        std::fill(m_Min.begin(), m_Min.end(), std::numeric_limits<T>::max());
+        std::fill(m_Max.begin(), m_Max.end(), std::numeric_limits<T>::lowest());
+        std::fill(m_Sum.begin(), m_Sum.end(), 0.0);
+        m_WindowSamples = 0;
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    BackgroundFileWriter m_Writer;
+    T *m_Variable;
+
+    // Indices of neurons to record
+    std::vector<unsigned int> m_Neurons;
+    bool m_Gather;
+
+    const unsigned int m_Interval;
+    const Mode m_Mode;
+    unsigned int m_Step;
+
+    // Summary statistics for current window
+    std::vector<T> m_Min;
+    std::vector<T> m_Max;
+    std::vector<double> m_Sum;
+    unsigned int m_WindowSamples;
+    double m_WindowEndTime;
+};
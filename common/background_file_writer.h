@@ -0,0 +1,148 @@
+#pragma once
+
+// Standard C++ includes
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Standard C includes
+#include <cstring>
+
+//----------------------------------------------------------------------------
+// BackgroundFileWriter
+//----------------------------------------------------------------------------
+//! Binary file writer which copies data into one of two preallocated buffers
+//! and hands full buffers to a writer thread. The simulation thread only
+//! blocks if the writer thread is still busy with the other buffer
+class BackgroundFileWriter
+{
+public:
+    BackgroundFileWriter(const char *filename, size_t bufferBytes = 1024 * 1024)
+    :   m_Stream(filename, std::ios::binary), m_FrontBuffer(0), m_FrontBytes(0), m_BackBytes(0), m_Stop(false)
+    {
+        if(!m_Stream.good()) {
+            throw std::runtime_error("Cannot open '" + std::string(filename) + "' for writing");
+        }
+
+        m_Buffers[0].resize(bufferBytes);
+        m_Buffers[1].resize(bufferBytes);
+
+        m_WriterThread = std::thread(&BackgroundFileWriter::writerThreadHandler, this);
+    }
+
+    ~BackgroundFileWriter()
+    {
+        // Hand any remaining data to the writer thread
+        if(m_FrontBytes > 0) {
+            swapBuffers();
+        }
+
+        // Signal writer thread to stop once it's written everything and wait for it
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_Condition.notify_one();
+        m_WriterThread.join();
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Copy numBytes of data into the current buffer
+    void write(const void *data, size_t numBytes)
+    {
+        std::memcpy(reserve(numBytes), data, numBytes);
+    }
+
+    //! Get a pointer to numBytes of space in the current buffer to fill directly
+    char *reserve(size_t numBytes)
+    {
+        auto &frontBuffer = m_Buffers[m_FrontBuffer];
+
+        // If there isn't space in the front buffer, hand it to the writer thread
+        if((m_FrontBytes + numBytes) > frontBuffer.size()) {
+            swapBuffers();
+
+            // If this single write is larger than a whole buffer, grow it
+            // **NOTE** this is the only case in which we allocate after construction
+            auto &newFrontBuffer = m_Buffers[m_FrontBuffer];
+            if(numBytes > newFrontBuffer.size()) {
+                newFrontBuffer.resize(numBytes);
+            }
+        }
+
+        char *data = &m_Buffers[m_FrontBuffer][m_FrontBytes];
+        m_FrontBytes += numBytes;
+        return data;
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    void swapBuffers()
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+
+        // Wait for writer thread to finish with back buffer
+        m_Condition.wait(lock, [this](){ return (m_BackBytes == 0); });
+
+        // Front buffer becomes back buffer
+        m_BackBytes = m_FrontBytes;
+        m_FrontBuffer ^= 1;
+        m_FrontBytes = 0;
+
+        lock.unlock();
+        m_Condition.notify_one();
+    }
+
+    void writerThreadHandler()
+    {
+        while(true) {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+
+            // Wait until there's something to write or we should stop
+            m_Condition.wait(lock, [this](){ return (m_BackBytes > 0 || m_Stop); });
+            if(m_BackBytes == 0) {
+                return;
+            }
+
+            // Write back buffer without holding lock
+            // **NOTE** front buffer index cannot change until back bytes is zeroed
+            const auto &backBuffer = m_Buffers[m_FrontBuffer ^ 1];
+            const size_t backBytes = m_BackBytes;
+            lock.unlock();
+            m_Stream.write(backBuffer.data(), backBytes);
+
+            // Mark back buffer as free
+            lock.lock();
+            m_BackBytes = 0;
+            lock.unlock();
+            m_Condition.notify_one();
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    std::ofstream m_Stream;
+
+    std::vector<char> m_Buffers[2];
+
+    // Index of buffer currently being filled and number of bytes in it
+    unsigned int m_FrontBuffer;
+    size_t m_FrontBytes;
+
+    // Number of bytes in other buffer waiting to be written (zero if it's free)
+    size_t m_BackBytes;
+    bool m_Stop;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::thread m_WriterThread;
+};
@@ -0,0 +1,234 @@
+#pragma once
+
+// Standard C++ includes
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Standard C includes
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// POSIX includes
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/types.h>
+    #include <unistd.h>
+#endif
+
+// Common includes
+#include "parallel_connectors.h"
+
+//----------------------------------------------------------------------------
+// ConnectivityCache
+//----------------------------------------------------------------------------
+//! Wraps the seeded connectivity builders in parallel_connectors.h with an
+//! on-disk cache. Each projection is stored in a file named after a hash of
+//! the parameters used to build it, containing a header followed by indInG
+//! and ind so it can be memory-mapped and copied straight into GeNN's arrays
+namespace ConnectivityCache
+{
+//----------------------------------------------------------------------------
+// Enumerations
+//----------------------------------------------------------------------------
+enum class ConnectorType : uint32_t
+{
+    FixedProbability,
+    FixedNumberPre,
+};
+
+//----------------------------------------------------------------------------
+// Header
+//----------------------------------------------------------------------------
+//! Header at the start of each cache file. Sized so the indices that follow are 8-byte aligned
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    ConnectorType connectorType;
+    uint32_t numPre;
+    uint32_t numPost;
+    double parameter;
+    uint64_t seed;
+    uint32_t connN;
+    uint32_t padding;
+};
+
+static_assert(sizeof(Header) == 48, "Connectivity cache header should be tightly packed");
+
+const char magic[8] = {'G', 'E', 'N', 'N', 'C', 'O', 'N', 'N'};
+const uint32_t version = 1;
+
+//----------------------------------------------------------------------------
+// Functions
+//----------------------------------------------------------------------------
+inline Header createHeader(ConnectorType connectorType, unsigned int numPre, unsigned int numPost,
+                           double parameter, uint64_t seed)
+{
+    // **NOTE** zero so padding is deterministic
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.connectorType = connectorType;
+    header.numPre = numPre;
+    header.numPost = numPost;
+    header.parameter = parameter;
+    header.seed = seed;
+    return header;
+}
+//----------------------------------------------------------------------------
+inline bool headerMatches(const Header &a, const Header &b)
+{
+    return (memcmp(a.magic, b.magic, sizeof(magic)) == 0 && a.version == b.version
+            && a.connectorType == b.connectorType && a.numPre == b.numPre && a.numPost == b.numPost
+            && a.parameter == b.parameter && a.seed == b.seed);
+}
+//----------------------------------------------------------------------------
+//! Get path of file used to cache connectivity with this header
+inline std::string getFilename(const std::string &directory, const Header &header)
+{
+    // FNV-1a hash header (excluding connN which isn't known until connectivity is built)
+    uint64_t hash = 14695981039346656037ull;
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(&header);
+    for(size_t b = 0; b < offsetof(Header, connN); b++) {
+        hash = (hash ^ bytes[b]) * 1099511628211ull;
+    }
+
+    std::stringstream filename;
+    filename << directory << "/connectivity_" << std::hex << hash << ".bin";
+    return filename.str();
+}
+//----------------------------------------------------------------------------
+#ifndef _WIN32
+//! Try to load connectivity from cache file, returning false if it's missing or doesn't match
+inline bool load(const std::string &filename, const Header &header,
+                 SparseProjection &projection, AllocateFn allocate)
+{
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+
+    // Get file size and check it's large enough to contain a header
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || (size_t)fileStat.st_size < sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+
+    // Map file into memory
+    const size_t fileSize = (size_t)fileStat.st_size;
+    void *mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED) {
+        return false;
+    }
+
+    // Check header matches and file is the correct size
+    const Header *fileHeader = reinterpret_cast<const Header*>(mapping);
+    const size_t expectedSize = sizeof(Header) + (sizeof(uint32_t) * ((size_t)header.numPre + 1 + fileHeader->connN));
+    const bool valid = headerMatches(header, *fileHeader) && (fileSize == expectedSize);
+    if(valid) {
+        const uint32_t *indInG = reinterpret_cast<const uint32_t*>(fileHeader + 1);
+        const uint32_t *ind = indInG + header.numPre + 1;
+
+        // Allocate SparseProjection arrays and copy in indices
+        // **NOTE** GeNN owns these arrays so copying out of the mapping is the best we can do
+        allocate(fileHeader->connN);
+        std::copy_n(indInG, header.numPre + 1, &projection.indInG[0]);
+        std::copy_n(ind, fileHeader->connN, &projection.ind[0]);
+    }
+
+    munmap(mapping, fileSize);
+    return valid;
+}
+//----------------------------------------------------------------------------
+//! Write connectivity to cache file
+inline void save(const std::string &directory, const std::string &filename, Header header,
+                 const SparseProjection &projection)
+{
+    // Make sure directory exists
+    mkdir(directory.c_str(), 0755);
+
+    // Write to a temporary file and then rename it so other processes
+    // launched in a parameter sweep never see a partially-written file
+    const std::string tempFilename = filename + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream stream(tempFilename, std::ios::binary);
+        if(!stream.good()) {
+            std::cerr << "Cannot write connectivity cache file '" << tempFilename << "'" << std::endl;
+            return;
+        }
+
+        header.connN = projection.indInG[header.numPre];
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        stream.write(reinterpret_cast<const char*>(&projection.indInG[0]), sizeof(uint32_t) * (header.numPre + 1));
+        stream.write(reinterpret_cast<const char*>(&projection.ind[0]), sizeof(uint32_t) * header.connN);
+    }
+
+    if(rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Cannot rename connectivity cache file to '" << filename << "'" << std::endl;
+        remove(tempFilename.c_str());
+    }
+}
+#endif  // _WIN32
+//----------------------------------------------------------------------------
+//! Load connectivity from cache if possible, otherwise build it with buildFn and add it to the cache
+template<typename BuildFn>
+void build(const std::string &directory, ConnectorType connectorType, unsigned int numPre, unsigned int numPost,
+           double parameter, uint64_t seed, SparseProjection &projection, AllocateFn allocate, BuildFn buildFn)
+{
+    static_assert(sizeof(projection.ind[0]) == sizeof(uint32_t), "Cached indices must be 32-bit");
+
+#ifdef _WIN32
+    (void)directory;
+    (void)connectorType;
+    (void)numPre;
+    (void)numPost;
+    (void)parameter;
+    (void)seed;
+    buildFn(projection, allocate);
+#else
+    const Header header = createHeader(connectorType, numPre, numPost, parameter, seed);
+    const std::string filename = getFilename(directory, header);
+
+    if(!load(filename, header, projection, allocate)) {
+        buildFn(projection, allocate);
+        save(directory, filename, header, projection);
+    }
+#endif
+}
+}   // namespace ConnectivityCache
+
+//----------------------------------------------------------------------------
+// Functions
+//----------------------------------------------------------------------------
+inline void buildFixedProbabilityConnectorCached(unsigned int numPre, unsigned int numPost, float probability,
+                                                 SparseProjection &projection, AllocateFn allocate, uint64_t seed,
+                                                 const std::string &cacheDirectory = "connectivity_cache")
+{
+    ConnectivityCache::build(cacheDirectory, ConnectivityCache::ConnectorType::FixedProbability,
+                             numPre, numPost, probability, seed, projection, allocate,
+                             [=](SparseProjection &p, AllocateFn a)
+                             {
+                                 buildFixedProbabilityConnectorParallel(numPre, numPost, probability, p, a, seed);
+                             });
+}
+//----------------------------------------------------------------------------
+inline void buildFixedNumberPreConnectorCached(unsigned int numPre, unsigned int numPost, unsigned int numConnections,
+                                               SparseProjection &projection, AllocateFn allocate, uint64_t seed,
+                                               const std::string &cacheDirectory = "connectivity_cache")
+{
+    ConnectivityCache::build(cacheDirectory, ConnectivityCache::ConnectorType::FixedNumberPre,
+                             numPre, numPost, numConnections, seed, projection, allocate,
+                             [=](SparseProjection &p, AllocateFn a)
+                             {
+                                 buildFixedNumberPreConnectorParallel(numPre, numPost, numConnections, p, a, seed);
+                             });
+}
@@ -2,6 +2,8 @@
 
 // Standard C++ includes
 #include <algorithm>
+#include <numeric>
+#include <random>
 #include <stdexcept>
 #include <vector>
 
@@ -17,6 +19,16 @@
 //----------------------------------------------------------------------------
 typedef void (*AllocateFn)(unsigned int);
 
+//----------------------------------------------------------------------------
+// FixedProbabilitySampling
+//----------------------------------------------------------------------------
+//! How buildFixedProbabilityConnector decides which synapses to create
+enum class FixedProbabilitySampling
+{
+    Dense,          //!< Draw one uniform random number for every (pre, post) pair
+    GeometricSkip,  //!< Draw gaps between synapses from a geometric distribution
+};
+
 //----------------------------------------------------------------------------
 // Functions
 //----------------------------------------------------------------------------
@@ -129,50 +141,79 @@ inline void addSynapseToSparseProjection(unsigned int i, unsigned int j, unsigne
                    });
 }
 
+//----------------------------------------------------------------------------
+// Append postsynaptic indices of one row of a fixed probability connector to ind
+template <typename Generator>
+void sampleFixedProbabilityRow(unsigned int numPost, float probability, FixedProbabilitySampling sampling,
+                               std::vector<unsigned int> &ind, Generator &gen)
+{
+    // If there are no connections or every connection is present, no random numbers are required
+    if(probability <= 0.0f) {
+        return;
+    }
+    else if(probability >= 1.0f) {
+        for(unsigned int j = 0; j < numPost; j++) {
+            ind.push_back(j);
+        }
+    }
+    else if(sampling == FixedProbabilitySampling::Dense) {
+        // Create RNG to draw probabilities
+        std::uniform_real_distribution<> dis(0.0, 1.0);
+
+        // Loop through post neurons
+        for(unsigned int j = 0; j < numPost; j++) {
+            // If there should be a connection here, add one to temporary array
+            if(dis(gen) < probability) {
+                ind.push_back(j);
+            }
+        }
+    }
+    else {
+        // The number of failed Bernoulli trials before the next success is geometrically
+        // distributed so we can jump straight from one synapse to the next
+        // **NOTE** 64-bit so gaps drawn with tiny probabilities can't overflow
+        std::geometric_distribution<unsigned long long> gap(probability);
+        for(unsigned long long j = gap(gen); j < numPost; j += 1 + gap(gen)) {
+            ind.push_back((unsigned int)j);
+        }
+    }
+}
 //----------------------------------------------------------------------------
 template <typename Generator>
 void buildFixedProbabilityConnector(unsigned int numPre, unsigned int numPost, float probability,
-                                    SparseProjection &projection, AllocateFn allocate, Generator &gen)
+                                    SparseProjection &projection, AllocateFn allocate, Generator &gen,
+                                    FixedProbabilitySampling sampling = FixedProbabilitySampling::GeometricSkip)
 {
-  // Allocate memory for indices
-  // **NOTE** RESIZE as this vector is populated by index
-  std::vector<unsigned int> tempIndInG;
-  tempIndInG.resize(numPre + 1);
-
-  // Reserve a temporary vector to store indices
-  std::vector<unsigned int> tempInd;
-  tempInd.reserve((unsigned int)((float)(numPre * numPost) * probability));
-
-  // Create RNG to draw probabilities
-  std::uniform_real_distribution<> dis(0.0, 1.0);
-
-  // Loop through pre neurons
-  for(unsigned int i = 0; i < numPre; i++)
-  {
-    // Connections from this neuron start at current end of indices
-    tempIndInG[i] = tempInd.size();
-
-    // Loop through post neurons
-    for(unsigned int j = 0; j < numPost; j++)
+    // Allocate memory for indices
+    // **NOTE** RESIZE as this vector is populated by index
+    std::vector<unsigned int> tempIndInG;
+    tempIndInG.resize(numPre + 1);
+
+    // Reserve a temporary vector to store indices
+    // **NOTE** calculate in double precision as numPre * numPost can overflow
+    std::vector<unsigned int> tempInd;
+    tempInd.reserve((size_t)((double)numPre * (double)numPost * (double)probability));
+
+    // Loop through pre neurons
+    for(unsigned int i = 0; i < numPre; i++)
     {
-      // If there should be a connection here, add one to temporary array
-      if(dis(gen) < probability)
-      {
-        tempInd.push_back(j);
-      }
+        // Connections from this neuron start at current end of indices
+        tempIndInG[i] = tempInd.size();
+
+        // Add this neuron's connections to temporary array
+        sampleFixedProbabilityRow(numPost, probability, sampling, tempInd, gen);
     }
-  }
 
-  // Add final index
-  tempIndInG[numPre] = tempInd.size();
+    // Add final index
+    tempIndInG[numPre] = tempInd.size();
 
-  // Allocate SparseProjection arrays
-  // **NOTE** shouldn't do directly as underneath it may use CUDA or host functions
-  allocate(tempInd.size());
+    // Allocate SparseProjection arrays
+    // **NOTE** shouldn't do directly as underneath it may use CUDA or host functions
+    allocate(tempInd.size());
 
-  // Copy indices
-  std::copy(tempIndInG.begin(), tempIndInG.end(), &projection.indInG[0]);
-  std::copy(tempInd.begin(), tempInd.end(), &projection.ind[0]);
+    // Copy indices
+    std::copy(tempIndInG.begin(), tempIndInG.end(), &projection.indInG[0]);
+    std::copy(tempInd.begin(), tempInd.end(), &projection.ind[0]);
 }
 //----------------------------------------------------------------------------
 unsigned int calcFixedProbabilityConnectorMaxConnections(unsigned int numPre, unsigned int numPost, double probability)
@@ -188,31 +229,56 @@ template <typename Generator>
 void buildFixedNumberPreConnector(unsigned int numPre, unsigned int numPost, unsigned int numConnections,
                                   SparseProjection &projection, AllocateFn allocate, Generator &gen)
 {
+    assert(numConnections <= numPre);
+
     // Allocate sparse projection
     allocate(numPost * numConnections);
 
-    // Zero all indInG
-    std::fill(&projection.indInG[0], &projection.indInG[numPre + 1], 0);
-
     // Generate array of presynaptic indices
     std::vector<unsigned int> preIndices(numPre);
     std::iota(preIndices.begin(), preIndices.end(), 0);
 
+    // Temporary array to hold the presynaptic neurons picked for each postsynaptic neuron
+    // **NOTE** this is populated column-by-column as connections are drawn for each postsynaptic neuron
+    std::vector<unsigned int> tempPreInd(numPost * numConnections);
+
+    // Zero row lengths
+    std::vector<unsigned int> rowLength(numPre, 0);
+
     // Loop through postsynaptic neurons
+    unsigned int s = 0;
     for(unsigned int j = 0; j < numPost; j++) {
         // Loop through connections to make
         for(unsigned int c = 1; c <= numConnections; c++) {
             // Create distribution to select from remaining available neurons
-            std::uniform_int_distribution<> dis(0, numPre - c);
+            std::uniform_int_distribution<unsigned int> dis(0, numPre - c);
 
             // Pick a presynaptic neuron
-            const unsigned int i = preIndices[dis(gen)];
+            const unsigned int p = dis(gen);
+            const unsigned int i = preIndices[p];
 
-            // Add synapse to projection
-            addSynapseToSparseProjection(i, j, numPre, projection);
+            // Record choice and count synapse in row
+            tempPreInd[s++] = i;
+            rowLength[i]++;
 
             // Swap the last available preindex with the one we have now used
-            std::swap(preIndices[i], preIndices[numPre - c]);
+            std::swap(preIndices[p], preIndices[numPre - c]);
+        }
+    }
+
+    // Prefix sum row lengths to get start of each row
+    projection.indInG[0] = 0;
+    std::partial_sum(rowLength.cbegin(), rowLength.cend(), &projection.indInG[1]);
+
+    // Re-use row lengths as write pointers into each row
+    std::copy(&projection.indInG[0], &projection.indInG[numPre], rowLength.begin());
+
+    // Scatter postsynaptic indices into rows
+    // **NOTE** as postsynaptic neurons are visited in order, each row ends up sorted
+    s = 0;
+    for(unsigned int j = 0; j < numPost; j++) {
+        for(unsigned int c = 0; c < numConnections; c++) {
+            projection.ind[rowLength[tempPreInd[s++]]++] = j;
         }
     }
 
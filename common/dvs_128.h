@@ -59,6 +59,12 @@ public:
         m_DVS128Handle.dataStop();
     }
 
+    //! Live devices never run out of events
+    bool isFinished() const
+    {
+        return false;
+    }
+
     void readEvents(unsigned int &spikeCount, unsigned int *spikes)
     {
         // Zero spike count
@@ -0,0 +1,212 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Standard C includes
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// POSIX includes
+#include <sys/stat.h>
+#include <unistd.h>
+
+//----------------------------------------------------------------------------
+// DVSEventIndex
+//----------------------------------------------------------------------------
+//! Sidecar index mapping time to byte offset within a pre-recorded text
+//! event file so readers can seek without parsing everything before. Entry k
+//! holds the offset of the first line whose time (relative to the start of
+//! the recording) is >= k * interval ms. The index is written alongside the
+//! event file the first time it's needed and rebuilt if the event file changes
+class DVSEventIndex
+{
+public:
+    //------------------------------------------------------------------------
+    // Enumerations
+    //------------------------------------------------------------------------
+    enum class Format : uint32_t
+    {
+        CSV,    //!< Header line followed by 'timestamp [us],x,y,polarity' lines as read by DVSPreRecorded
+        Ms,     //!< 'timestep [ms];address,address...' lines as read by DVSPreRecordedMs
+    };
+
+    DVSEventIndex(const std::string &eventFilename, Format format, unsigned int intervalMs = 1000)
+        : m_IntervalMs(intervalMs), m_FirstTimestamp(0)
+    {
+        // Get size and modification time of event file
+        struct stat fileStat;
+        if(stat(eventFilename.c_str(), &fileStat) != 0) {
+            throw std::runtime_error("Cannot stat event file '" + eventFilename + "'");
+        }
+
+        // Try and load existing index, otherwise build and save one
+        const std::string indexFilename = eventFilename + ".idx";
+        if(!load(indexFilename, format, fileStat)) {
+            build(eventFilename, format);
+            save(indexFilename, format, fileStat);
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Get byte offset of a line at or before the first line at timeMs
+    uint64_t getOffset(double timeMs) const
+    {
+        if(timeMs <= 0.0 || m_Offsets.empty()) {
+            return m_Offsets.empty() ? 0 : m_Offsets.front();
+        }
+
+        const size_t entry = std::min(m_Offsets.size() - 1, (size_t)std::floor(timeMs / (double)m_IntervalMs));
+        return m_Offsets[entry];
+    }
+
+    //! Get timestamp of first event in file (only meaningful for Format::CSV)
+    uint64_t getFirstTimestamp() const{ return m_FirstTimestamp; }
+
+private:
+    //------------------------------------------------------------------------
+    // Header
+    //------------------------------------------------------------------------
+    struct Header
+    {
+        char magic[8];
+        Format format;
+        uint32_t intervalMs;
+        uint64_t eventFileSize;
+        int64_t eventFileModificationTime;
+        uint64_t firstTimestamp;
+        uint64_t numEntries;
+    };
+
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    Header createHeader(Format format, const struct stat &eventFileStat) const
+    {
+        Header header;
+        memset(&header, 0, sizeof(Header));
+        memcpy(header.magic, "GENNIDX1", 8);
+        header.format = format;
+        header.intervalMs = m_IntervalMs;
+        header.eventFileSize = (uint64_t)eventFileStat.st_size;
+        header.eventFileModificationTime = (int64_t)eventFileStat.st_mtime;
+        header.firstTimestamp = m_FirstTimestamp;
+        header.numEntries = m_Offsets.size();
+        return header;
+    }
+
+    bool load(const std::string &indexFilename, Format format, const struct stat &eventFileStat)
+    {
+        std::ifstream stream(indexFilename, std::ios::binary);
+        if(!stream.good()) {
+            return false;
+        }
+
+        // Read header and check it matches this event file
+        Header header;
+        const Header expected = createHeader(format, eventFileStat);
+        if(!stream.read(reinterpret_cast<char*>(&header), sizeof(Header))
+            || memcmp(header.magic, expected.magic, 8) != 0 || header.format != expected.format
+            || header.intervalMs != expected.intervalMs || header.eventFileSize != expected.eventFileSize
+            || header.eventFileModificationTime != expected.eventFileModificationTime)
+        {
+            return false;
+        }
+
+        // Read offsets
+        // **NOTE** read into temporary so a truncated index leaves nothing behind for build to append to
+        std::vector<uint64_t> offsets(header.numEntries);
+        if(!stream.read(reinterpret_cast<char*>(offsets.data()), sizeof(uint64_t) * header.numEntries)) {
+            return false;
+        }
+
+        m_FirstTimestamp = header.firstTimestamp;
+        m_Offsets.swap(offsets);
+        return true;
+    }
+
+    void build(const std::string &eventFilename, Format format)
+    {
+        std::ifstream stream(eventFilename);
+
+        // Skip CSV header
+        uint64_t offset = 0;
+        std::string line;
+        if(format == Format::CSV) {
+            std::getline(stream, line);
+            offset += line.size() + 1;
+        }
+
+        // Loop through lines
+        // **NOTE** time of each line is parsed from the first field only
+        const uint64_t intervalUs = (uint64_t)m_IntervalMs * 1000;
+        bool firstLine = true;
+        while(std::getline(stream, line) && !line.empty()) {
+            // Get time of line in us relative to start of recording
+            uint64_t timeUs = std::strtoull(line.c_str(), nullptr, 10);
+            if(format == Format::CSV) {
+                if(firstLine) {
+                    m_FirstTimestamp = timeUs;
+                }
+                timeUs -= m_FirstTimestamp;
+            }
+            else {
+                timeUs *= 1000;
+            }
+            firstLine = false;
+
+            // Add entries for every interval up to and including the one this line starts
+            while(((uint64_t)m_Offsets.size() * intervalUs) <= timeUs) {
+                m_Offsets.push_back(offset);
+            }
+
+            offset += line.size() + 1;
+        }
+
+        // Add final entry pointing at end of file
+        m_Offsets.push_back(offset);
+    }
+
+    void save(const std::string &indexFilename, Format format, const struct stat &eventFileStat) const
+    {
+        // Write to a temporary file and then rename it so other processes
+        // reading the same recording never see a partially-written index
+        // **NOTE** failing to write an index (e.g. read-only dataset directory) isn't fatal
+        const std::string tempFilename = indexFilename + "." + std::to_string(getpid()) + ".tmp";
+        {
+            std::ofstream stream(tempFilename, std::ios::binary);
+            if(!stream.good()) {
+                return;
+            }
+
+            const Header header = createHeader(format, eventFileStat);
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            stream.write(reinterpret_cast<const char*>(m_Offsets.data()), sizeof(uint64_t) * m_Offsets.size());
+            if(!stream.good()) {
+                stream.close();
+                remove(tempFilename.c_str());
+                return;
+            }
+        }
+
+        if(rename(tempFilename.c_str(), indexFilename.c_str()) != 0) {
+            remove(tempFilename.c_str());
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const unsigned int m_IntervalMs;
+    uint64_t m_FirstTimestamp;
+    std::vector<uint64_t> m_Offsets;
+};
@@ -0,0 +1,62 @@
+import argparse
+import struct
+
+# Converts pre-recorded DVS events into the binary format read by DVSPreRecordedBinary
+# csv: header line followed by 'timestamp [us],x,y,polarity' lines as read by DVSPreRecorded
+# ms: 'timestep [ms];address,address,...' lines as read by DVSPreRecordedMs
+parser = argparse.ArgumentParser(description="Convert DVS events to binary format")
+parser.add_argument("input", help="Text event file")
+parser.add_argument("output", help="Binary event file to write")
+parser.add_argument("--format", choices=["csv", "ms"], required=True)
+parser.add_argument("--width", type=int, default=128)
+parser.add_argument("--height", type=int, default=128)
+parser.add_argument("--flip-y", action="store_true", help="Flip events vertically")
+args = parser.parse_args()
+
+def read_csv(input_file):
+    # Skip header
+    input_file.readline()
+
+    for line in input_file:
+        cells = line.split(",")
+        if len(cells) < 3:
+            continue
+
+        polarity = int(cells[3]) if len(cells) > 3 else 1
+        yield int(cells[0]), int(cells[1]), int(cells[2]), polarity
+
+def read_ms(input_file):
+    for line in input_file:
+        line = line.strip()
+        if not line:
+            break
+
+        # Addresses are row-major so convert back to x and y
+        # **NOTE** this format has no polarity so mark all events as on
+        # **NOTE** timesteps with no events have an empty address list
+        time_string, address_string = line.split(";")
+        timestamp = int(time_string) * 1000
+        for a in filter(None, address_string.split(",")):
+            y, x = divmod(int(a), args.width)
+            yield timestamp, x, y, 1
+
+with open(args.input, "r") as input_file:
+    events = list(read_csv(input_file) if args.format == "csv" else read_ms(input_file))
+
+# Events should already be in order but make sure
+events.sort(key=lambda e: e[0])
+
+# CSV replay starts at first event whereas ms replay starts at timestep zero
+start_timestamp = (events[0][0] if events else 0) if args.format == "csv" else 0
+
+event_struct = struct.Struct("<IHH")
+with open(args.output, "wb") as output_file:
+    output_file.write(b"GENNDVS1")
+    output_file.write(struct.pack("<IIIIQ", args.width, args.height, start_timestamp, 0, len(events)))
+
+    for t, x, y, p in events:
+        if args.flip_y:
+            y = args.height - 1 - y
+        output_file.write(event_struct.pack(t, x, y | (0x8000 if p else 0)))
+
+print("Converted %u events" % len(events))
@@ -2,11 +2,18 @@
 
 // Standard C++ includes
 #include <fstream>
+#include <limits>
+#include <sstream>
 #include <string>
 
 // Standard C includes
+#include <cassert>
+#include <cstdint>
 #include <cstdlib>
 
+// Common includes
+#include "dvs_event_index.h"
+
 //----------------------------------------------------------------------------
 // DVSPreRecorded
 //----------------------------------------------------------------------------
@@ -24,16 +31,17 @@ public:
     };
 
     DVSPreRecorded(const char *spikeFilename, Polarity polarity, double dt, bool flipY = false, unsigned int width = 128, unsigned int height = 128)
-        : m_SpikeStream(spikeFilename), m_Polarity(polarity), m_FrameDurationUs((unsigned int)(dt * 1000.0)),
-          m_FlipY(flipY), m_Width(width), m_Height(height), m_FirstSpike(true), m_FrameStartTimestamp(0)
+        : m_SpikeFilename(spikeFilename), m_SpikeStream(spikeFilename), m_Polarity(polarity), m_FrameDurationUs((unsigned int)(dt * 1000.0)),
+          m_FlipY(flipY), m_Width(width), m_Height(height), m_FirstSpike(true), m_FrameStartTimestamp(0),
+          m_FrameTimeUs(0), m_EndTimeUs(std::numeric_limits<uint64_t>::max())
     {
         assert(m_SpikeStream.good());
 
         // Read header line
-        std::getline(m_SpikeStream, m_NextLine);
+        readNextLine();
 
         // Read first spike line
-        std::getline(m_SpikeStream, m_NextLine);
+        readNextLine();
     }
 
     //------------------------------------------------------------------------
@@ -47,14 +55,51 @@ public:
     {
     }
 
+    //! Seek to timeMs after the first spike in the file using a sidecar index
+    void seek(double timeMs, unsigned int indexIntervalMs = 1000)
+    {
+        DVSEventIndex index(m_SpikeFilename, DVSEventIndex::Format::CSV, indexIntervalMs);
+
+        // Start frame at requested time
+        m_FrameTimeUs = (uint64_t)(timeMs * 1000.0);
+        m_FrameStartTimestamp = (unsigned int)(index.getFirstTimestamp() + m_FrameTimeUs);
+        m_FirstSpike = false;
+
+        // Seek to indexed line before start time
+        m_SpikeStream.clear();
+        m_SpikeStream.seekg(index.getOffset(timeMs));
+
+        // Skip any lines belonging to earlier frames
+        // **NOTE** frames after the first include their end but not their start timestamp
+        while(readNextLine() && (m_FrameTimeUs > 0) && std::stoul(m_NextLine) <= m_FrameStartTimestamp)
+        {
+        }
+    }
+
+    //! Stop returning events timeMs after the first spike in the file
+    void setEndTime(double timeMs)
+    {
+        m_EndTimeUs = (uint64_t)(timeMs * 1000.0);
+    }
+
+    bool isFinished() const
+    {
+        return (m_NextLine.empty() || m_FrameTimeUs >= m_EndTimeUs);
+    }
+
     void readEvents(unsigned int &spikeCount, unsigned int *spikes)
     {
         // Zero spike count
         spikeCount = 0;
 
+        // If we've reached the end of the file or the replay window, stop
+        if(isFinished()) {
+            return;
+        }
+
         // Loop through spikes in frame
         std::string cell;
-        do
+        while(!m_NextLine.empty())
         {
             // Create string stream from line
             std::stringstream lineStream(m_NextLine);
@@ -100,12 +145,12 @@ public:
             }
 
             // Read next spike into buffer
-            std::getline(m_SpikeStream, m_NextLine);
+            readNextLine();
         }
-        while(m_SpikeStream.good());
 
         // Update frame start timestamp for next frame
         m_FrameStartTimestamp += m_FrameDurationUs;
+        m_FrameTimeUs += m_FrameDurationUs;
     }
 
     unsigned int getWidth() const
@@ -119,9 +164,24 @@ public:
     }
 
 private:
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    //! Read next line into m_NextLine, returning false and leaving it empty at the end of the file or an empty line
+    bool readNextLine()
+    {
+        // **NOTE** if the last line has no trailing newline, the read which hits
+        // EOF returns it but the failed read after that leaves it in the string
+        if(!std::getline(m_SpikeStream, m_NextLine)) {
+            m_NextLine.clear();
+        }
+        return !m_NextLine.empty();
+    }
+
     //------------------------------------------------------------------------
     // Members
     //------------------------------------------------------------------------
+    const std::string m_SpikeFilename;
     std::ifstream m_SpikeStream;
     const Polarity m_Polarity;
     const unsigned int m_FrameDurationUs;
@@ -132,4 +192,8 @@ private:
     bool m_FirstSpike;
     unsigned int m_FrameStartTimestamp;
 
+    // Time since start of recording and time to stop replay
+    uint64_t m_FrameTimeUs;
+    uint64_t m_EndTimeUs;
+
 };
\ No newline at end of file
@@ -0,0 +1,205 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// Standard C includes
+#include <cstdint>
+#include <cstring>
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//----------------------------------------------------------------------------
+// DVSBinaryHeader
+//----------------------------------------------------------------------------
+//! Header of binary DVS event files written by dvs_events_to_binary.py
+struct DVSBinaryHeader
+{
+    char magic[8];              // "GENNDVS1"
+    uint32_t width;
+    uint32_t height;
+    uint32_t startTimestamp;    // Timestamp (us) first frame starts at
+    uint32_t padding;
+    uint64_t numEvents;
+};
+
+static_assert(sizeof(DVSBinaryHeader) == 32, "DVS binary header should be tightly packed");
+
+//----------------------------------------------------------------------------
+// DVSBinaryEvent
+//----------------------------------------------------------------------------
+//! Event as stored in binary DVS event files, sorted by timestamp
+struct DVSBinaryEvent
+{
+    uint32_t timestamp;         // Timestamp in us
+    uint16_t x;
+    uint16_t yPolarity;         // Y coordinate in low 15 bits, polarity in top bit
+
+    uint16_t getY() const{ return (yPolarity & 0x7FFF); }
+    bool getPolarity() const{ return (yPolarity & 0x8000) != 0; }
+};
+
+static_assert(sizeof(DVSBinaryEvent) == 8, "DVS binary event should be tightly packed");
+
+//----------------------------------------------------------------------------
+// DVSPreRecordedBinary
+//----------------------------------------------------------------------------
+//! Replays events from a memory-mapped binary event file. Each call to
+//! readEvents returns the events within the next dt ms, starting from the
+//! start timestamp stored in the header, without any parsing or allocation.
+//! As events are sorted, seek uses a binary search rather than an index
+class DVSPreRecordedBinary
+{
+public:
+    //------------------------------------------------------------------------
+    // Enumerations
+    //------------------------------------------------------------------------
+    enum class Polarity
+    {
+        On,
+        Off,
+        Both,
+    };
+
+    DVSPreRecordedBinary(const char *eventFilename, Polarity polarity, double dt, bool flipY = false)
+        : m_Polarity(polarity), m_FrameDurationUs((unsigned int)(dt * 1000.0)), m_FlipY(flipY),
+          m_Mapping(MAP_FAILED), m_MappingSize(0), m_Header(nullptr), m_Events(nullptr), m_NextEvent(0),
+          m_EndTimestamp(std::numeric_limits<uint64_t>::max())
+    {
+        const int fd = open(eventFilename, O_RDONLY);
+        if(fd < 0) {
+            throw std::runtime_error("Cannot open event file '" + std::string(eventFilename) + "'");
+        }
+
+        // Get file size
+        struct stat fileStat;
+        if(fstat(fd, &fileStat) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot stat event file '" + std::string(eventFilename) + "'");
+        }
+
+        // Map file into memory
+        m_MappingSize = (size_t)fileStat.st_size;
+        m_Mapping = mmap(nullptr, m_MappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(m_Mapping == MAP_FAILED) {
+            throw std::runtime_error("Cannot map event file '" + std::string(eventFilename) + "'");
+        }
+
+        // We read events in order so let kernel read ahead aggressively
+        madvise(m_Mapping, m_MappingSize, MADV_SEQUENTIAL);
+
+        // Check header
+        m_Header = reinterpret_cast<const DVSBinaryHeader*>(m_Mapping);
+        if(m_MappingSize < sizeof(DVSBinaryHeader) || memcmp(m_Header->magic, "GENNDVS1", 8) != 0
+            || m_MappingSize != (sizeof(DVSBinaryHeader) + (sizeof(DVSBinaryEvent) * m_Header->numEvents)))
+        {
+            munmap(m_Mapping, m_MappingSize);
+            throw std::runtime_error("'" + std::string(eventFilename) + "' is not a valid binary event file");
+        }
+
+        m_Events = reinterpret_cast<const DVSBinaryEvent*>(m_Header + 1);
+        m_FrameEndTimestamp = (uint64_t)m_Header->startTimestamp + m_FrameDurationUs;
+    }
+
+    ~DVSPreRecordedBinary()
+    {
+        munmap(m_Mapping, m_MappingSize);
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    void start()
+    {
+    }
+
+    void stop()
+    {
+    }
+
+    //! Seek to timeMs after the start of the recording
+    void seek(double timeMs)
+    {
+        const uint64_t frameStartTimestamp = m_Header->startTimestamp + (uint64_t)(timeMs * 1000.0);
+        m_NextEvent = std::lower_bound(m_Events, m_Events + m_Header->numEvents, frameStartTimestamp,
+                                       [](const DVSBinaryEvent &e, uint64_t t){ return (e.timestamp < t); }) - m_Events;
+        m_FrameEndTimestamp = frameStartTimestamp + m_FrameDurationUs;
+    }
+
+    //! Stop returning events timeMs after the start of the recording
+    void setEndTime(double timeMs)
+    {
+        m_EndTimestamp = m_Header->startTimestamp + (uint64_t)(timeMs * 1000.0);
+    }
+
+    bool isFinished() const
+    {
+        return (m_NextEvent >= m_Header->numEvents || (m_FrameEndTimestamp - m_FrameDurationUs) >= m_EndTimestamp);
+    }
+
+    void readEvents(unsigned int &spikeCount, unsigned int *spikes)
+    {
+        // Zero spike count
+        spikeCount = 0;
+
+        // If we've reached the end of the replay window, stop
+        if((m_FrameEndTimestamp - m_FrameDurationUs) >= m_EndTimestamp) {
+            return;
+        }
+
+        // Loop through events in frame
+        const uint64_t numEvents = m_Header->numEvents;
+        const unsigned int maxY = m_Header->height - 1;
+        for(; m_NextEvent < numEvents && m_Events[m_NextEvent].timestamp < m_FrameEndTimestamp; m_NextEvent++) {
+            const DVSBinaryEvent &event = m_Events[m_NextEvent];
+
+            // If polarity is one we care about
+            if(m_Polarity == Polarity::Both
+                || (m_Polarity == Polarity::On && event.getPolarity())
+                || (m_Polarity == Polarity::Off && !event.getPolarity()))
+            {
+                // Calculate row-major spike address
+                const unsigned int y = m_FlipY ? (maxY - event.getY()) : event.getY();
+                spikes[spikeCount++] = event.x + (y * m_Header->width);
+            }
+        }
+
+        // Update frame end timestamp for next frame
+        m_FrameEndTimestamp += m_FrameDurationUs;
+    }
+
+    unsigned int getWidth() const
+    {
+        return m_Header->width;
+    }
+
+    unsigned int getHeight() const
+    {
+        return m_Header->height;
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const Polarity m_Polarity;
+    const unsigned int m_FrameDurationUs;
+    const bool m_FlipY;
+
+    void *m_Mapping;
+    size_t m_MappingSize;
+    const DVSBinaryHeader *m_Header;
+    const DVSBinaryEvent *m_Events;
+
+    uint64_t m_NextEvent;
+    uint64_t m_FrameEndTimestamp;
+    uint64_t m_EndTimestamp;
+};
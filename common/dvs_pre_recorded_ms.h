@@ -1,12 +1,17 @@
 #pragma once
 
 // Standard C++ includes
-#include <fstream>
+#include <algorithm>
+#include <limits>
 #include <string>
 #include <vector>
 
 // Standard C includes
-#include <cstdlib>
+#include <cmath>
+
+// Common includes
+#include "dvs_event_index.h"
+#include "timestep_spike_reader.h"
 
 //----------------------------------------------------------------------------
 // DVSPreRecordedMs
@@ -15,10 +20,9 @@ class DVSPreRecordedMs
 {
 public:
     DVSPreRecordedMs(const char *spikeFilename)
-        : m_SpikeStream(spikeFilename), m_NextInputTimestep(0), m_Timestep(0), m_MoreSpikes(false)
+        : m_SpikeFilename(spikeFilename), m_SpikeReader(spikeFilename), m_NextInputTimestep(0), m_Timestep(0),
+          m_EndTimestep(std::numeric_limits<unsigned int>::max()), m_MoreSpikes(false)
     {
-        assert(m_SpikeStream.good());
-
         // Read next input
         m_MoreSpikes = readNext();
     }
@@ -34,11 +38,42 @@ public:
     {
     }
 
+    //! Seek to timestep timeMs using a sidecar index
+    void seek(double timeMs, unsigned int indexIntervalMs = 1000)
+    {
+        DVSEventIndex index(m_SpikeFilename, DVSEventIndex::Format::Ms, indexIntervalMs);
+
+        // Seek to indexed line before start time
+        m_Timestep = (unsigned int)std::round(timeMs);
+        m_SpikeReader.seek(index.getOffset(timeMs));
+
+        // Skip any lines before start time
+        do {
+            m_MoreSpikes = readNext();
+        } while(m_MoreSpikes && m_NextInputTimestep < m_Timestep);
+    }
+
+    //! Stop returning events at timestep timeMs
+    void setEndTime(double timeMs)
+    {
+        m_EndTimestep = (unsigned int)std::round(timeMs);
+    }
+
+    bool isFinished() const
+    {
+        return (!m_MoreSpikes || m_Timestep >= m_EndTimestep);
+    }
+
     void readEvents(unsigned int &spikeCount, unsigned int *spikes)
     {
         // Zero spike count
         spikeCount = 0;
 
+        // If we've reached the end of the replay window, stop
+        if(m_Timestep >= m_EndTimestep) {
+            return;
+        }
+
         // If we should supply input this timestep
         if(m_MoreSpikes && m_NextInputTimestep == m_Timestep) {
             // Copy into spike source
@@ -69,43 +104,19 @@ private:
     //------------------------------------------------------------------------
     bool readNext()
     {
-         // Read lines into string
-        std::string line;
-        std::getline(m_SpikeStream, line);
-
-        if(line.empty()) {
-            return false;
-        }
-
-        // Create string stream from line
-        std::stringstream lineStream(line);
-
-        // Read time from start of line
-        std::string nextTimeString;
-        std::getline(lineStream, nextTimeString, ';');
-        m_NextInputTimestep = (unsigned int)std::stoul(nextTimeString);
-
-        // Clear existing addresses
-        m_NextInputAddresses.clear();
-
-        while(lineStream.good()) {
-            // Read input spike index
-            std::string inputIndexString;
-            std::getline(lineStream, inputIndexString, ',');
-            m_NextInputAddresses.push_back(std::atoi(inputIndexString.c_str()));
-        }
-
-        return true;
+        return m_SpikeReader.readNext(m_NextInputTimestep, m_NextInputAddresses);
     }
 
     //------------------------------------------------------------------------
     // Members
     //------------------------------------------------------------------------
-    std::ifstream m_SpikeStream;
+    const std::string m_SpikeFilename;
+    TimestepSpikeReader m_SpikeReader;
 
     std::vector<unsigned int> m_NextInputAddresses;
     unsigned int m_NextInputTimestep;
     unsigned int m_Timestep;
+    unsigned int m_EndTimestep;
     bool m_MoreSpikes;
 
 };
\ No newline at end of file
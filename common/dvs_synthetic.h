@@ -0,0 +1,302 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Standard C includes
+#include <cmath>
+#include <cstdint>
+
+//----------------------------------------------------------------------------
+// DVSSynthetic
+//----------------------------------------------------------------------------
+//! Procedurally renders a simple scene every timestep and, like an idealised
+//! DVS, emits an event from every pixel whose brightness changed since the
+//! previous timestep, optionally mixed with uniformly distributed noise
+//! events. Entirely determined by its parameters and seed so can stand in
+//! for a DVS128 or pre-recorded events in tests, with known ground truth
+class DVSSynthetic
+{
+public:
+    //------------------------------------------------------------------------
+    // Enumerations
+    //------------------------------------------------------------------------
+    enum class Polarity
+    {
+        On,
+        Off,
+        Both,
+    };
+
+    enum class Scene
+    {
+        MovingBar,              //!< Bright bars moving across the sensor
+        LoomingDisc,            //!< Disc expanding as if approaching at constant speed
+        TexturedTranslation,    //!< Random block texture translating across the sensor
+    };
+
+    //------------------------------------------------------------------------
+    // Params
+    //------------------------------------------------------------------------
+    struct Params
+    {
+        Params() : width(128), height(128), speed(100.0), direction(0.0), barWidth(8), textureScale(4),
+            loomDuration(1000.0), loomRadius(4.0), noiseRate(0.0), seed(1234)
+        {
+        }
+
+        unsigned int width;
+        unsigned int height;
+
+        double speed;           //!< Speed of bars and texture (pixels per second)
+        double direction;       //!< Direction of bars and texture (radians)
+        unsigned int barWidth;  //!< Width of bars (pixels)
+        unsigned int textureScale;  //!< Size of texture blocks (pixels)
+        double loomDuration;    //!< Time from start of approach to collision (ms)
+        double loomRadius;      //!< Radius of disc at start of approach (pixels)
+        double noiseRate;       //!< Rate of noise events across whole sensor (events per second)
+        uint64_t seed;
+    };
+
+    DVSSynthetic(Scene scene, Polarity polarity, double dt, const Params &params = Params())
+        : m_Scene(scene), m_Polarity(polarity), m_DT(dt), m_Params(params),
+          m_Frame(params.width * params.height), m_PreviousFrame(params.width * params.height),
+          m_Timestep(0), m_EndTimestep(std::numeric_limits<unsigned int>::max()), m_RNG(params.seed)
+    {
+        // Generate random texture
+        m_Texture.resize(TextureSize * TextureSize);
+        for(auto &t : m_Texture) {
+            t = (uint8_t)(m_RNG() & 1);
+        }
+
+        // Render initial frame so there's no burst of events in the first timestep
+        render(0.0, m_PreviousFrame);
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    void start()
+    {
+    }
+
+    void stop()
+    {
+    }
+
+    //! Jump to timeMs
+    void seek(double timeMs)
+    {
+        m_Timestep = (unsigned int)std::round(timeMs / m_DT);
+        render(getTime(), m_PreviousFrame);
+    }
+
+    //! Stop returning events at timeMs
+    void setEndTime(double timeMs)
+    {
+        m_EndTimestep = (unsigned int)std::round(timeMs / m_DT);
+    }
+
+    bool isFinished() const
+    {
+        return (m_Timestep >= m_EndTimestep);
+    }
+
+    void readEvents(unsigned int &spikeCount, unsigned int *spikes)
+    {
+        // Zero spike count
+        spikeCount = 0;
+
+        // If we've reached the end of the run, stop
+        if(isFinished()) {
+            return;
+        }
+
+        // Render frame at end of timestep
+        m_Timestep++;
+        render(getTime(), m_Frame);
+
+        // Emit events from pixels whose brightness has changed
+        const unsigned int numPixels = m_Params.width * m_Params.height;
+        for(unsigned int i = 0; i < numPixels; i++) {
+            if(m_Frame[i] != m_PreviousFrame[i]) {
+                const bool on = (m_Frame[i] > m_PreviousFrame[i]);
+                if(m_Polarity == Polarity::Both || (m_Polarity == Polarity::On) == on) {
+                    spikes[spikeCount++] = i;
+                }
+            }
+        }
+        std::swap(m_Frame, m_PreviousFrame);
+
+        // Add noise events
+        // **NOTE** std::distributions aren't portable between standard libraries so sample manually
+        if(m_Params.noiseRate > 0.0) {
+            const double expected = m_Params.noiseRate * m_DT / 1000.0;
+            unsigned int numNoise = (unsigned int)expected;
+            if(getUniform() < (expected - (double)numNoise)) {
+                numNoise++;
+            }
+
+            // Noise events can't overflow spike array
+            numNoise = std::min(numNoise, numPixels - spikeCount);
+            for(unsigned int n = 0; n < numNoise; n++) {
+                spikes[spikeCount++] = (unsigned int)(m_RNG() % numPixels);
+            }
+        }
+    }
+
+    unsigned int getWidth() const
+    {
+        return m_Params.width;
+    }
+
+    unsigned int getHeight() const
+    {
+        return m_Params.height;
+    }
+
+    //! Get time of the last frame rendered (ms)
+    double getTime() const
+    {
+        return (double)m_Timestep * m_DT;
+    }
+
+    //! Get ground truth velocity of scene (pixels per second)
+    void getVelocity(double &x, double &y) const
+    {
+        if(m_Scene == Scene::LoomingDisc) {
+            x = 0.0;
+            y = 0.0;
+        }
+        else {
+            x = m_Params.speed * std::cos(m_Params.direction);
+            y = m_Params.speed * std::sin(m_Params.direction);
+        }
+    }
+
+    //! Get ground truth radius of looming disc (pixels)
+    double getDiscRadius() const
+    {
+        return getDiscRadius(getTime());
+    }
+
+    //------------------------------------------------------------------------
+    // Static API
+    //------------------------------------------------------------------------
+    static Scene parseScene(const std::string &name)
+    {
+        if(name == "bar") {
+            return Scene::MovingBar;
+        }
+        else if(name == "loom") {
+            return Scene::LoomingDisc;
+        }
+        else if(name == "texture") {
+            return Scene::TexturedTranslation;
+        }
+        else {
+            throw std::runtime_error("Unknown synthetic scene '" + name + "' - expected bar, loom or texture");
+        }
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Constants
+    //------------------------------------------------------------------------
+    // Texture is tiled from a square of this many blocks
+    static constexpr int TextureSize = 64;
+
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    double getDiscRadius(double t) const
+    {
+        // Disc approaches at constant speed so radius is inversely proportional to
+        // time to collision - repeat approach once it fills the sensor
+        const double remaining = m_Params.loomDuration - std::fmod(t, m_Params.loomDuration);
+        return m_Params.loomRadius * m_Params.loomDuration / std::max(remaining, m_DT);
+    }
+
+    double getUniform()
+    {
+        return (double)(m_RNG() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    void render(double t, std::vector<uint8_t> &frame) const
+    {
+        const double cosDirection = std::cos(m_Params.direction);
+        const double sinDirection = std::sin(m_Params.direction);
+        const double distance = m_Params.speed * t / 1000.0;
+
+        switch(m_Scene) {
+        case Scene::MovingBar:
+        {
+            // Bars are perpendicular to direction of motion and repeat once they leave the sensor
+            const double period = (double)(m_Params.width + m_Params.height);
+            for(unsigned int y = 0; y < m_Params.height; y++) {
+                for(unsigned int x = 0; x < m_Params.width; x++) {
+                    const double d = ((double)x * cosDirection) + ((double)y * sinDirection) - distance;
+                    const double phase = d - (period * std::floor(d / period));
+                    frame[x + (y * m_Params.width)] = (phase < (double)m_Params.barWidth) ? 1 : 0;
+                }
+            }
+            break;
+        }
+
+        case Scene::LoomingDisc:
+        {
+            const double radius = getDiscRadius(t);
+            const double centreX = 0.5 * (double)m_Params.width;
+            const double centreY = 0.5 * (double)m_Params.height;
+            for(unsigned int y = 0; y < m_Params.height; y++) {
+                for(unsigned int x = 0; x < m_Params.width; x++) {
+                    const double dx = (double)x + 0.5 - centreX;
+                    const double dy = (double)y + 0.5 - centreY;
+                    frame[x + (y * m_Params.width)] = (((dx * dx) + (dy * dy)) < (radius * radius)) ? 0 : 1;
+                }
+            }
+            break;
+        }
+
+        case Scene::TexturedTranslation:
+        {
+            const double offsetX = distance * cosDirection;
+            const double offsetY = distance * sinDirection;
+            const double scale = (double)m_Params.textureScale;
+            for(unsigned int y = 0; y < m_Params.height; y++) {
+                const int blockY = (int)std::floor(((double)y - offsetY) / scale);
+                const int textureY = ((blockY % TextureSize) + TextureSize) % TextureSize;
+                for(unsigned int x = 0; x < m_Params.width; x++) {
+                    const int blockX = (int)std::floor(((double)x - offsetX) / scale);
+                    const int textureX = ((blockX % TextureSize) + TextureSize) % TextureSize;
+                    frame[x + (y * m_Params.width)] = m_Texture[textureX + (textureY * TextureSize)];
+                }
+            }
+            break;
+        }
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const Scene m_Scene;
+    const Polarity m_Polarity;
+    const double m_DT;
+    const Params m_Params;
+
+    // Current and previous rendered frames
+    std::vector<uint8_t> m_Frame;
+    std::vector<uint8_t> m_PreviousFrame;
+    std::vector<uint8_t> m_Texture;
+
+    unsigned int m_Timestep;
+    unsigned int m_EndTimestep;
+
+    std::mt19937_64 m_RNG;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+// Standard C++ includes
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+// Standard C includes
+#include <cstddef>
+#include <cstdint>
+
+//----------------------------------------------------------------------------
+// FlowField
+//----------------------------------------------------------------------------
+//! Accumulates spikes from a grid of motion detectors into a decaying 2D
+//! vector field. Detector populations are laid out with the detectors of each
+//! cell adjacent and cells in row-major order (as in optical_flow) and each
+//! detector adds +/-1 to one axis of its cell's vector. The vectors are stored
+//! contiguously as [x][y][axis] so a lookup table can map each spike straight
+//! to the float it updates and decay is a single vectorisable loop.
+class FlowField
+{
+public:
+    //! detectors specifies the (axis, increment) of each detector within a cell
+    FlowField(unsigned int width, unsigned int height, float persistence,
+              std::initializer_list<std::pair<unsigned int, float>> detectors)
+    :   m_Width(width), m_Height(height), m_Persistence(persistence), m_Vectors(width * height * 2, 0.0f)
+    {
+        // Build lookup table from detector neuron ID to vector component and increment
+        const unsigned int numDetectors = (unsigned int)detectors.size();
+        m_Offsets.reserve(width * height * numDetectors);
+        m_Increments.reserve(width * height * numDetectors);
+        for(unsigned int y = 0; y < height; y++) {
+            for(unsigned int x = 0; x < width; x++) {
+                for(const auto &d : detectors) {
+                    m_Offsets.push_back((((x * height) + y) * 2) + d.first);
+                    m_Increments.push_back(d.second);
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Add spikes emitted by detectors this timestep and then decay field
+    void apply(unsigned int spikeCount, const unsigned int *spikes)
+    {
+        const uint32_t *offsets = m_Offsets.data();
+        const float *increments = m_Increments.data();
+        float *vectors = m_Vectors.data();
+        for(unsigned int s = 0; s < spikeCount; s++) {
+            const unsigned int spike = spikes[s];
+            vectors[offsets[spike]] += increments[spike];
+        }
+
+        decay();
+    }
+
+    //! Decay every vector component by persistence
+    void decay()
+    {
+        float *vectors = m_Vectors.data();
+        const size_t numComponents = m_Vectors.size();
+        for(size_t i = 0; i < numComponents; i++) {
+            vectors[i] *= m_Persistence;
+        }
+    }
+
+    unsigned int getWidth() const{ return m_Width; }
+    unsigned int getHeight() const{ return m_Height; }
+
+    //! Get vector components, laid out as [x][y][axis]
+    const std::vector<float> &getVectors() const{ return m_Vectors; }
+    float *getData(){ return m_Vectors.data(); }
+
+    //! Get one axis of the vector at x, y
+    float get(unsigned int x, unsigned int y, unsigned int axis) const
+    {
+        return m_Vectors[(((x * m_Height) + y) * 2) + axis];
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const unsigned int m_Width;
+    const unsigned int m_Height;
+    const float m_Persistence;
+
+    std::vector<float> m_Vectors;
+
+    // Lookup table indexed by detector neuron ID
+    std::vector<uint32_t> m_Offsets;
+    std::vector<float> m_Increments;
+};
@@ -1,7 +1,10 @@
 #pragma once
 
 // Standard C++ includes
+#include <atomic>
 #include <iostream>
+#include <stdexcept>
+#include <thread>
 
 // OpenCV includes
 #include <opencv2/imgproc/imgproc.hpp>
@@ -11,35 +14,61 @@
 #include <opencv2/gpu/gpu.hpp>
 #endif  // CPU_ONLY
 
+// Common includes
+#include "triple_buffer.h"
+
 //----------------------------------------------------------------------------
 // OpenCVDVS
 //----------------------------------------------------------------------------
 //! Uses OpenCV video capture interface to provide low-resolution, square 
 //! Image consisting of difference between frames:
-//! pipe into a layer of neurons and bob's your cheap DVS uncle
+//! pipe into a layer of neurons and bob's your cheap DVS uncle.
+//! Frames are captured on a separate thread so camera latency doesn't
+//! serialise with simulation. As the simulation typically runs much faster
+//! than the camera, a new frame difference is only calculated when the camera
+//! has produced a new frame - on all other calls update returns zeros (just
+//! like a real DVS emits nothing when nothing changes) but the show methods
+//! continue to display the latest difference
 class OpenCVDVS
 {
 public:
     OpenCVDVS(unsigned int device, unsigned int resolution, bool absolute)
-        : m_Camera(device), m_Resolution(resolution), m_Absolute(absolute)
+        : m_Camera(device), m_Resolution(resolution), m_Absolute(absolute), m_FrameNumber(0),
+          m_StopCapture(false), m_CaptureFailed(false)
     {
         // Check camera has opened correctly
         if(!m_Camera.isOpened()) {
             throw std::runtime_error("Cannot open camera");
         }
         
-         // Read first frame from camera
-        readFrame();
+        // Calculate square Region of Interest within raw frames
+        const unsigned int width = m_Camera.get(CV_CAP_PROP_FRAME_WIDTH);
+        const unsigned int height = m_Camera.get(CV_CAP_PROP_FRAME_HEIGHT);
+        const unsigned int margin = (width - height) / 2;
+        m_CameraSquare = cv::Rect(cv::Point(margin, 0), cv::Point(width - margin, height));
+        
+        // Read first frame from camera
+        // **NOTE** this is taken by the first call to readFrame
+        if(!m_Camera.read(m_RawFrames.getWriteBuffer())) {
+            throw std::runtime_error("Cannot read first frame");
+        }
+        m_RawFrames.publish();
         
-        // Create square Region of Interest within raw frame
-        m_SquareROI = m_RawFrame(getCameraSquare());       
+        // Start capturing subsequent frames in background
+        m_CaptureThread = std::thread(&OpenCVDVS::captureThreadHandler, this);
+    }
+    
+    virtual ~OpenCVDVS()
+    {
+        m_StopCapture = true;
+        m_CaptureThread.join();
     }
     
     //----------------------------------------------------------------------------
     // Declared virtuals
     //----------------------------------------------------------------------------
-    virtual std::pair<float*, unsigned int> update(unsigned int i) = 0;
-    virtual void showDownsampledFrame(const char *name, unsigned int i) = 0;
+    virtual std::pair<float*, unsigned int> update() = 0;
+    virtual void showDownsampledFrame(const char *name) = 0;
     virtual void showFrameDifference(const char *name) = 0;
     virtual void showGreyscaleFrame(const char *name) = 0;
     
@@ -48,28 +77,39 @@ public:
     //----------------------------------------------------------------------------
     void showRawFrame(const char *name)
     {
-        cv::imshow(name, m_RawFrame);
+        cv::imshow(name, m_RawFrames.getReadBuffer());
     }
     
 protected:
     //----------------------------------------------------------------------------
     // Protected methods
     //----------------------------------------------------------------------------
-    void readFrame()
+    //! Switch to latest frame captured, returning false if camera hasn't produced a new one
+    bool readFrame()
     {
-        if(!m_Camera.read(m_RawFrame)) {
-            throw std::runtime_error("Cannot read first frame");
+        if(!m_RawFrames.update()) {
+            // If capture thread has given up, there will be no more frames
+            if(m_CaptureFailed) {
+                throw std::runtime_error("Cannot read frame");
+            }
+            return false;
         }
+        
+        // Create square Region of Interest within raw frame
+        m_SquareROI = m_RawFrames.getReadBuffer()(m_CameraSquare);
+        m_FrameNumber++;
+        return true;
     }
     
-    cv::Rect getCameraSquare()
+    //! Get sequence number of current frame (starting at 1 for first frame)
+    unsigned int getFrameNumber() const
     {
-        // Get frame dimensions
-        const unsigned int width = m_Camera.get(CV_CAP_PROP_FRAME_WIDTH);
-        const unsigned int height = m_Camera.get(CV_CAP_PROP_FRAME_HEIGHT);
-         
-        const unsigned int margin = (width - height) / 2;
-        return cv::Rect(cv::Point(margin, 0), cv::Point(width - margin, height));
+        return m_FrameNumber;
+    }
+    
+    cv::Rect getCameraSquare() const
+    {
+        return m_CameraSquare;
     }
     
     unsigned int getResolution() const
@@ -88,6 +128,21 @@ protected:
     }
     
 private:
+    //----------------------------------------------------------------------------
+    // Private methods
+    //----------------------------------------------------------------------------
+    void captureThreadHandler()
+    {
+        while(!m_StopCapture) {
+            // If read fails, stop capturing and let readFrame report it on simulation thread
+            if(!m_Camera.read(m_RawFrames.getWriteBuffer())) {
+                m_CaptureFailed = true;
+                break;
+            }
+            m_RawFrames.publish();
+        }
+    }
+    
     //----------------------------------------------------------------------------
     // Members
     //----------------------------------------------------------------------------
@@ -99,11 +154,21 @@ private:
     // Should frame difference be absolute
     const bool m_Absolute;
     
-    // Full resolution, colour frame read directly from camera
-    cv::Mat m_RawFrame;
+    // Full resolution, colour frames read directly from camera by capture thread
+    TripleBuffer<cv::Mat> m_RawFrames;
+    
+    // Square region of interest within raw frames
+    cv::Rect m_CameraSquare;
     
-    // Square region of interest within m_RawFrame used for subsequent processing
+    // Square region of interest within latest raw frame used for subsequent processing
     cv::Mat m_SquareROI;
+    
+    // Sequence number of latest raw frame
+    unsigned int m_FrameNumber;
+    
+    std::atomic<bool> m_StopCapture;
+    std::atomic<bool> m_CaptureFailed;
+    std::thread m_CaptureThread;
 };
 
 //----------------------------------------------------------------------------
@@ -112,8 +177,18 @@ private:
 class OpenCVDVSCPU : public OpenCVDVS
 {
 public:
+    //----------------------------------------------------------------------------
+    // Enumerations
+    //----------------------------------------------------------------------------
+    enum class Polarity
+    {
+        On,
+        Off,
+        Both,
+    };
+    
     OpenCVDVSCPU(unsigned int device, unsigned int resolution, bool absolute=false)
-        : OpenCVDVS(device, resolution, absolute)
+        : OpenCVDVS(device, resolution, absolute), m_EventThreshold(0.1f), m_EventPolarity(Polarity::Both)
     {
         // Initialize and zero the two downsampled image
         m_DownsampledFrames[0].create(getResolution(), getResolution(), CV_32FC1);
@@ -121,19 +196,114 @@ public:
         m_DownsampledFrames[0].setTo(0);
         m_DownsampledFrames[1].setTo(0);
         
-        // Create 3rd image to hold output
+        // Create 3rd image to hold output and 4th to output when there's no new frame
         m_FrameDifference.create(getResolution(), getResolution(), CV_32FC1);
         m_FrameDifference.setTo(0);
+        m_NoFrameDifference.create(getResolution(), getResolution(), CV_32FC1);
+        m_NoFrameDifference.setTo(0);
     }
     
     //----------------------------------------------------------------------------
     // OpenCVDVS virtuals
     //----------------------------------------------------------------------------
-    virtual std::pair<float*, unsigned int> update(unsigned int i) override
+    virtual std::pair<float*, unsigned int> update() override
+    {
+        // Return frame difference data directly if there is a new one, otherwise zeros
+        const cv::Mat &frameDifference = updateFrameDifference() ? m_FrameDifference : m_NoFrameDifference;
+        return std::make_pair(reinterpret_cast<float*>(frameDifference.data),
+                              getResolution());
+    }
+    
+    virtual void showDownsampledFrame(const char *name) override
+    {
+        cv::imshow(name, m_DownsampledFrames[getFrameNumber() % 2]);
+    }
+
+    virtual void showFrameDifference(const char *name) override
+    {
+        cv::imshow(name, m_FrameDifference);
+    }
+
+    virtual void showGreyscaleFrame(const char *name) override
+    {
+        cv::imshow(name, m_GreyscaleFrame);
+    }
+
+    //----------------------------------------------------------------------------
+    // Public API
+    //----------------------------------------------------------------------------
+    const cv::Mat &getFrameDifference() const{ return m_FrameDifference; }
+    
+    //----------------------------------------------------------------------------
+    // Event-based API
+    //----------------------------------------------------------------------------
+    // Rather than a dense frame difference, readEvents emits the addresses of pixels
+    // whose difference exceeds a threshold in the same form as DVS128::readEvents
+    void setEventThreshold(float threshold, Polarity polarity = Polarity::Both)
+    {
+        m_EventThreshold = threshold;
+        m_EventPolarity = polarity;
+    }
+    
+    void start()
+    {
+    }
+    
+    void stop()
+    {
+    }
+    
+    bool isFinished() const
+    {
+        return false;
+    }
+    
+    void readEvents(unsigned int &spikeCount, unsigned int *spikes)
+    {
+        // If camera hasn't produced a new frame, nothing has changed
+        spikeCount = 0;
+        if(!updateFrameDifference()) {
+            return;
+        }
+        
+        // Loop through pixels and emit events from those which have changed enough
+        const unsigned int resolution = getResolution();
+        for(unsigned int y = 0; y < resolution; y++) {
+            const float *row = m_FrameDifference.ptr<float>(y);
+            for(unsigned int x = 0; x < resolution; x++) {
+                if((m_EventPolarity != Polarity::Off && row[x] > m_EventThreshold)
+                    || (m_EventPolarity != Polarity::On && row[x] < -m_EventThreshold))
+                {
+                    spikes[spikeCount++] = x + (y * resolution);
+                }
+            }
+        }
+    }
+    
+    unsigned int getWidth() const
+    {
+        return getResolution();
+    }
+    
+    unsigned int getHeight() const
     {
+        return getResolution();
+    }
+    
+private:
+    //----------------------------------------------------------------------------
+    // Private methods
+    //----------------------------------------------------------------------------
+    //! Calculate difference between latest frame and previous one, returning false if there is no new frame
+    bool updateFrameDifference()
+    {
+        if(!readFrame()) {
+            return false;
+        }
+        
         // Get references to current and previous down-sampled frame
-        auto &curDownSampledFrame = m_DownsampledFrames[i % 2];
-        auto &prevDownSampledFrame = m_DownsampledFrames[(i + 1) % 2];
+        auto &curDownSampledFrame = m_DownsampledFrames[getFrameNumber() % 2];
+        auto &prevDownSampledFrame = m_DownsampledFrames[(getFrameNumber() + 1) % 2];
         
         // Convert square frame to floating-point using CPU
         cv::cvtColor(getSquareROI(), m_GreyscaleFrame, CV_BGR2GRAY);
@@ -146,7 +316,7 @@ public:
                    cv::Size(getResolution(), getResolution()));
         
         // If this isn't first frame, calculate difference with previous frame
-        if(i > 0) {
+        if(getFrameNumber() > 1) {
             if(isAbsolute()) {
                 cv::absdiff(curDownSampledFrame, prevDownSampledFrame, m_FrameDifference);
             }
@@ -154,36 +324,9 @@ public:
                 cv::subtract(curDownSampledFrame, prevDownSampledFrame, m_FrameDifference);
             }
         }
-    
-        // Read next frame
-        readFrame();
-
-        // Return frame difference data directly
-        return std::make_pair(reinterpret_cast<float*>(m_FrameDifference.data),
-                              getResolution());
+        return true;
     }
     
-    virtual void showDownsampledFrame(const char *name, unsigned int i) override
-    {
-        cv::imshow(name, m_DownsampledFrames[i % 2]);
-    }
-    
-    virtual void showFrameDifference(const char *name) override
-    {
-        cv::imshow(name, m_FrameDifference);
-    }
-
-    virtual void showGreyscaleFrame(const char *name) override
-    {
-        cv::imshow(name, m_GreyscaleFrame);
-    }
-
-    //----------------------------------------------------------------------------
-    // Public API
-    //----------------------------------------------------------------------------
-    const cv::Mat &getFrameDifference() const{ return m_FrameDifference; }
-    
-private:
     //----------------------------------------------------------------------------
     // Members
     //----------------------------------------------------------------------------
@@ -191,6 +334,13 @@ private:
     
     cv::Mat m_DownsampledFrames[2];
     cv::Mat m_FrameDifference;
+    
+    // Zeros returned by update when there is no new frame
+    cv::Mat m_NoFrameDifference;
+    
+    // Event-based API state
+    float m_EventThreshold;
+    Polarity m_EventPolarity;
 };
 
 //----------------------------------------------------------------------------
@@ -213,19 +363,28 @@ public:
         m_DownsampledFrames[0].setTo(0);
         m_DownsampledFrames[1].setTo(0);
         
-        // Create 3rd image to hold output
+        // Create 3rd image to hold output and 4th to output when there's no new frame
         m_FrameDifference.create(getResolution(), getResolution(), CV_32FC1);
         m_FrameDifference.setTo(0);
+        m_NoFrameDifference.create(getResolution(), getResolution(), CV_32FC1);
+        m_NoFrameDifference.setTo(0);
     }
     
     //----------------------------------------------------------------------------
     // OpenCVDVS virtuals
     //----------------------------------------------------------------------------
-    virtual std::pair<float*, unsigned int> update(unsigned int i, std::mutex &mutex) override
+    virtual std::pair<float*, unsigned int> update() override
     {
+        // If camera hasn't produced a new frame, return zeros
+        if(!readFrame()) {
+            auto noFrameDifferencePtrStep = (cv::gpu::PtrStep<float>)m_NoFrameDifference;
+            return std::make_pair(noFrameDifferencePtrStep.data,
+                                  noFrameDifferencePtrStep.step / sizeof(float));
+        }
+        
         // Get references to current and previous down-sampled frame
-        auto &curDownSampledFrame = m_DownsampledFrames[i % 2];
-        auto &prevDownSampledFrame = m_DownsampledFrames[(i + 1) % 2];
+        auto &curDownSampledFrame = m_DownsampledFrames[getFrameNumber() % 2];
+        auto &prevDownSampledFrame = m_DownsampledFrames[(getFrameNumber() + 1) % 2];
     
         // Upload camera data to GPU
         m_SquareROIGPU.upload(getSquareROI());
@@ -241,8 +400,7 @@ public:
                         cv::Size(getResolution(), getResolution()));
         
         // If this isn't first frame, calculate difference with previous frame
-        if(i > 0) {
-            std::lock_guard<std::mutex> lock(outputMutex);
+        if(getFrameNumber() > 1) {
             if(isAbsolute()) {
                 cv::gpu::absdiff(curDownSampledFrame, prevDownSampledFrame, m_FrameDifference);
             }
@@ -250,9 +408,6 @@ public:
                 cv::gpu::subtract(curDownSampledFrame, prevDownSampledFrame, m_FrameDifference);
             }
         }
-    
-        // Read next frame
-        readFrame();
         
         // Get low-level structure containing device pointer and stride and return
         auto frameDifferencePtrStep = (cv::gpu::PtrStep<float>)m_FrameDifference;
@@ -260,10 +415,10 @@ public:
                               frameDifferencePtrStep.step / sizeof(float));
     }
     
-    virtual void showDownsampledFrame(const char *name, unsigned int i) override
+    virtual void showDownsampledFrame(const char *name) override
     {
         cv::Mat downsampledFrame;
-        m_DownsampledFrames[i % 2].download(downsampledFrame);
+        m_DownsampledFrames[getFrameNumber() % 2].download(downsampledFrame);
         
         cv::imshow(name, downsampledFrame);
     }
@@ -301,5 +456,8 @@ private:
     // Downsampled frames to calculate output from
     cv::gpu::GpuMat m_DownsampledFrames[2];
     cv::gpu::GpuMat m_FrameDifference;
+    
+    // Zeros returned by update when there is no new frame
+    cv::gpu::GpuMat m_NoFrameDifference;
 };
 #endif  // CPU_ONLY
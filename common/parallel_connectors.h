@@ -0,0 +1,240 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+// Standard C includes
+#include <cassert>
+#include <cstdint>
+
+// Common includes
+#include "connectors.h"
+
+//----------------------------------------------------------------------------
+// StreamRNG
+//----------------------------------------------------------------------------
+//! Small counter-based generator (SplitMix64) whose state is derived from a
+//! seed and a stream index. Cheap enough to construct one per synaptic row
+//! so the random numbers used for a row don't depend on which thread builds it
+class StreamRNG
+{
+public:
+    typedef uint64_t result_type;
+
+    StreamRNG(uint64_t seed, uint64_t stream)
+        : m_State(mix(seed ^ mix(stream + 0x9E3779B97F4A7C15ull)))
+    {
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    static constexpr result_type min(){ return 0; }
+    static constexpr result_type max(){ return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        m_State += 0x9E3779B97F4A7C15ull;
+        return mix(m_State);
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Private static methods
+    //------------------------------------------------------------------------
+    static uint64_t mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    uint64_t m_State;
+};
+
+//----------------------------------------------------------------------------
+// Functions
+//----------------------------------------------------------------------------
+inline unsigned int getNumConnectorThreads(unsigned int numThreads, unsigned int numItems)
+{
+    // If number of threads isn't specified, use one per hardware thread
+    if(numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Don't use more threads than there are items to process
+    return std::max(1u, std::min(numThreads, numItems));
+}
+//----------------------------------------------------------------------------
+// Split [0, numItems) into numThreads contiguous chunks and call
+// func(thread, begin, end) on each from its own thread
+template<typename Func>
+void parallelForChunks(unsigned int numItems, unsigned int numThreads, Func func)
+{
+    const unsigned int chunkSize = (numItems + numThreads - 1) / numThreads;
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for(unsigned int t = 1; t < numThreads; t++) {
+        const unsigned int begin = std::min(numItems, t * chunkSize);
+        const unsigned int end = std::min(numItems, begin + chunkSize);
+        threads.emplace_back(func, t, begin, end);
+    }
+
+    // Process first chunk on calling thread
+    func(0, 0, std::min(numItems, chunkSize));
+
+    for(auto &t : threads) {
+        t.join();
+    }
+}
+//----------------------------------------------------------------------------
+// Multi-threaded version of buildFixedProbabilityConnector. Each presynaptic
+// row is sampled using a StreamRNG seeded with (seed, row index) so the
+// resultant connectivity is identical regardless of the number of threads
+inline void buildFixedProbabilityConnectorParallel(unsigned int numPre, unsigned int numPost, float probability,
+                                                   SparseProjection &projection, AllocateFn allocate, uint64_t seed,
+                                                   unsigned int numThreads = 0,
+                                                   FixedProbabilitySampling sampling = FixedProbabilitySampling::GeometricSkip)
+{
+    numThreads = getNumConnectorThreads(numThreads, numPre);
+
+    // Temporary vectors to hold indices generated by each thread
+    std::vector<std::vector<unsigned int>> threadInd(numThreads);
+
+    // Temporary vector to hold row lengths
+    // **NOTE** offset by one so it can be prefix summed in place
+    std::vector<unsigned int> tempIndInG(numPre + 1, 0);
+
+    // Sample rows
+    parallelForChunks(numPre, numThreads,
+        [&](unsigned int t, unsigned int begin, unsigned int end)
+        {
+            auto &ind = threadInd[t];
+            ind.reserve((size_t)((double)(end - begin) * (double)numPost * (double)probability));
+            for(unsigned int i = begin; i < end; i++) {
+                const size_t rowStart = ind.size();
+
+                StreamRNG gen(seed, i);
+                sampleFixedProbabilityRow(numPost, probability, sampling, ind, gen);
+
+                tempIndInG[i + 1] = (unsigned int)(ind.size() - rowStart);
+            }
+        });
+
+    // Prefix sum row lengths to get start of each row
+    std::partial_sum(tempIndInG.cbegin(), tempIndInG.cend(), tempIndInG.begin());
+
+    // Allocate SparseProjection arrays
+    // **NOTE** shouldn't do directly as underneath it may use CUDA or host functions
+    allocate(tempIndInG[numPre]);
+
+    // Copy indices
+    std::copy(tempIndInG.cbegin(), tempIndInG.cend(), &projection.indInG[0]);
+    parallelForChunks(numPre, numThreads,
+        [&](unsigned int t, unsigned int begin, unsigned int)
+        {
+            std::copy(threadInd[t].cbegin(), threadInd[t].cend(), &projection.ind[tempIndInG[begin]]);
+        });
+}
+//----------------------------------------------------------------------------
+// Multi-threaded version of buildFixedNumberPreConnector. The presynaptic
+// neurons connected to each postsynaptic neuron are drawn using a StreamRNG
+// seeded with (seed, postsynaptic index) so the resultant connectivity is
+// identical regardless of the number of threads
+inline void buildFixedNumberPreConnectorParallel(unsigned int numPre, unsigned int numPost, unsigned int numConnections,
+                                                 SparseProjection &projection, AllocateFn allocate, uint64_t seed,
+                                                 unsigned int numThreads = 0)
+{
+    assert(numConnections <= numPre);
+
+    numThreads = getNumConnectorThreads(numThreads, numPost);
+
+    // Allocate sparse projection
+    allocate(numPost * numConnections);
+
+    // Temporary array to hold the presynaptic neurons picked for each postsynaptic neuron
+    std::vector<unsigned int> tempPreInd(numPost * numConnections);
+
+    // Per-thread row lengths
+    std::vector<std::vector<unsigned int>> threadRowLength(numThreads);
+
+    // Draw presynaptic neurons for each postsynaptic neuron
+    parallelForChunks(numPost, numThreads,
+        [&](unsigned int t, unsigned int begin, unsigned int end)
+        {
+            auto &rowLength = threadRowLength[t];
+            rowLength.resize(numPre, 0);
+
+            // Generate array of presynaptic indices
+            std::vector<unsigned int> preIndices(numPre);
+            std::iota(preIndices.begin(), preIndices.end(), 0);
+
+            std::vector<unsigned int> drawn(numConnections);
+            for(unsigned int j = begin; j < end; j++) {
+                StreamRNG gen(seed, j);
+
+                // Partial Fisher-Yates shuffle to select presynaptic neurons without replacement
+                for(unsigned int c = 1; c <= numConnections; c++) {
+                    std::uniform_int_distribution<unsigned int> dis(0, numPre - c);
+                    const unsigned int p = dis(gen);
+                    const unsigned int i = preIndices[p];
+
+                    tempPreInd[(j * numConnections) + c - 1] = i;
+                    rowLength[i]++;
+
+                    std::swap(preIndices[p], preIndices[numPre - c]);
+                    drawn[c - 1] = p;
+                }
+
+                // Undo swaps in reverse order so the next postsynaptic neuron starts from the
+                // identity permutation, making its draws independent of those that preceded it
+                for(unsigned int c = numConnections; c >= 1; c--) {
+                    std::swap(preIndices[drawn[c - 1]], preIndices[numPre - c]);
+                }
+            }
+        });
+
+    // Prefix sum row lengths across threads to get start of each row
+    projection.indInG[0] = 0;
+    for(unsigned int i = 0; i < numPre; i++) {
+        unsigned int rowLength = 0;
+        for(auto &r : threadRowLength) {
+            rowLength += r[i];
+        }
+        projection.indInG[i + 1] = projection.indInG[i] + rowLength;
+    }
+
+    // Convert each thread's row lengths into write pointers into its section of each row
+    // **NOTE** threads process contiguous, ordered ranges of postsynaptic neurons so each row ends up sorted
+    for(unsigned int i = 0; i < numPre; i++) {
+        unsigned int rowPointer = projection.indInG[i];
+        for(auto &r : threadRowLength) {
+            const unsigned int rowLength = r[i];
+            r[i] = rowPointer;
+            rowPointer += rowLength;
+        }
+    }
+
+    // Scatter postsynaptic indices into rows
+    parallelForChunks(numPost, numThreads,
+        [&](unsigned int t, unsigned int begin, unsigned int end)
+        {
+            auto &rowPointer = threadRowLength[t];
+            for(unsigned int j = begin; j < end; j++) {
+                for(unsigned int c = 0; c < numConnections; c++) {
+                    projection.ind[rowPointer[tempPreInd[(j * numConnections) + c]]++] = j;
+                }
+            }
+        });
+
+    // Check correct number of connections were added
+    assert(projection.indInG[numPre] == projection.connN);
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// PrefetchingEventSource
+//----------------------------------------------------------------------------
+//! Wraps an event source (DVS128, DVSPreRecorded, DVSPreRecordedMs etc) and
+//! reads timesteps of events from it ahead of time on a separate thread into
+//! a lock-free single-producer, single-consumer ring of batches. readEvents
+//! then only has to hand over the next batch so disk or USB hiccups are
+//! absorbed by the ring rather than stalling the simulation loop.
+//! If the ring is empty when readEvents is called (a 'dry' tick), it waits
+//! for the next batch so no events are dropped or shifted in time.
+//! Batches are variable-length and packed into one shared arena sized for
+//! numBatches batches of typicalEventsPerBatch events, so a burst can use
+//! the space quieter batches leave free. The arena always has room for one
+//! batch of every pixel so even the largest batch can't stall the ring.
+//! For live devices, period should be set to the timestep so each batch
+//! contains one timestep of events; for pre-recorded sources leave it at zero.
+//! Live devices should use a shallow ring as it bounds how far behind the
+//! sensor the simulation can fall; getNumFullWaits reports when it did.
+template<typename Source>
+class PrefetchingEventSource
+{
+public:
+    PrefetchingEventSource(Source &source, size_t numBatches, size_t typicalEventsPerBatch,
+                           std::chrono::duration<double, std::milli> period = std::chrono::duration<double, std::milli>::zero())
+    :   m_Source(source), m_NumBatches(numBatches),
+        m_ArenaSize(std::max<size_t>(numBatches * typicalEventsPerBatch, source.getWidth() * source.getHeight())),
+        m_Period(period), m_Arena(m_ArenaSize), m_Offsets(m_NumBatches, 0), m_Counts(m_NumBatches, 0),
+        m_Head(0), m_Tail(0), m_Stop(false), m_SourceFinished(false), m_NumFullWaits(0),
+        m_Pending(source.getWidth() * source.getHeight()), m_PendingCount(0), m_HasPending(false), m_ArenaHead(0),
+        m_Current(nullptr), m_NumTicks(0), m_NumDryTicks(0), m_MinOccupancy(m_NumBatches)
+    {
+    }
+
+    ~PrefetchingEventSource()
+    {
+        stopThread();
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    void start()
+    {
+        m_Source.start();
+        m_Stop = false;
+        m_Thread = std::thread(&PrefetchingEventSource::prefetchThread, this);
+    }
+
+    void stop()
+    {
+        stopThread();
+        m_Source.stop();
+    }
+
+    //! Have all events been read from the source and handed over
+    bool isFinished() const
+    {
+        // **NOTE** the batch currently handed out hasn't been released yet
+        const size_t tail = m_Tail.load(std::memory_order_relaxed) + ((m_Current == nullptr) ? 0 : 1);
+        return (m_SourceFinished.load(std::memory_order_acquire) && tail == m_Head.load(std::memory_order_acquire));
+    }
+
+    //! Get pointer to next batch of events which remains valid until the next call
+    const unsigned int *readEvents(unsigned int &spikeCount)
+    {
+        // Release previous batch back to producer
+        size_t tail = m_Tail.load(std::memory_order_relaxed);
+        if(m_Current != nullptr) {
+            tail++;
+            m_Tail.store(tail, std::memory_order_release);
+            m_Current = nullptr;
+        }
+
+        // If ring has run dry, count and wait for producer
+        m_NumTicks++;
+        size_t head = m_Head.load(std::memory_order_acquire);
+        if(head == tail) {
+            m_NumDryTicks++;
+            while((head = m_Head.load(std::memory_order_acquire)) == tail) {
+                if(m_SourceFinished.load(std::memory_order_acquire) && m_Head.load(std::memory_order_acquire) == tail) {
+                    spikeCount = 0;
+                    return nullptr;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        // Track how close we came to running dry
+        m_MinOccupancy = std::min(m_MinOccupancy, head - tail);
+
+        const size_t batch = tail % m_NumBatches;
+        spikeCount = m_Counts[batch];
+        m_Current = &m_Arena[m_Offsets[batch] % m_ArenaSize];
+        return m_Current;
+    }
+
+    //! Copy next batch of events into spikes (e.g. a GeNN spike array)
+    void readEvents(unsigned int &spikeCount, unsigned int *spikes)
+    {
+        const unsigned int *events = readEvents(spikeCount);
+        std::copy_n(events, spikeCount, spikes);
+    }
+
+    unsigned int getWidth() const{ return m_Source.getWidth(); }
+    unsigned int getHeight() const{ return m_Source.getHeight(); }
+
+    //! Number of calls to readEvents
+    size_t getNumTicks() const{ return m_NumTicks; }
+
+    //! Number of calls to readEvents which found the ring empty and had to wait
+    size_t getNumDryTicks() const{ return m_NumDryTicks; }
+
+    //! Fewest batches which were ready when readEvents was called
+    size_t getMinOccupancy() const{ return m_MinOccupancy; }
+
+    //! Number of batches which had to wait for the consumer to free space in the ring
+    size_t getNumFullWaits() const{ return m_NumFullWaits.load(std::memory_order_relaxed); }
+
+    size_t getNumBatches() const{ return m_NumBatches; }
+
+private:
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    void prefetchThread()
+    {
+        auto nextRead = std::chrono::high_resolution_clock::now();
+        bool waited = false;
+        while(!m_Stop.load(std::memory_order_relaxed)) {
+            // If there's no batch waiting to be added to ring, read one
+            if(!m_HasPending) {
+                // If source has run out of events, stop
+                if(m_Source.isFinished()) {
+                    m_SourceFinished.store(true, std::memory_order_release);
+                    break;
+                }
+
+                // If source is live, wait until next batch is due
+                if(m_Period > std::chrono::duration<double, std::milli>::zero()) {
+                    nextRead += std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(m_Period);
+                    std::this_thread::sleep_until(nextRead);
+                }
+
+                // **NOTE** sources can produce up to one event per pixel so read into full-sized buffer
+                m_Source.readEvents(m_PendingCount, m_Pending.data());
+                m_HasPending = true;
+                waited = false;
+            }
+
+            // Find where batch would start in arena, skipping to the start if it won't fit before the end
+            size_t offset = m_ArenaHead;
+            if(((offset % m_ArenaSize) + m_PendingCount) > m_ArenaSize) {
+                offset += m_ArenaSize - (offset % m_ArenaSize);
+            }
+
+            // If ring has no free batches or the arena doesn't have room
+            // before the oldest batch the consumer hasn't released, wait for consumer
+            // **NOTE** if the ring is empty, the consumer isn't using any of the arena
+            const size_t head = m_Head.load(std::memory_order_relaxed);
+            const size_t tail = m_Tail.load(std::memory_order_acquire);
+            const size_t oldest = (head == tail) ? offset : m_Offsets[tail % m_NumBatches];
+            if((head - tail) == m_NumBatches || (offset + m_PendingCount - oldest) > m_ArenaSize) {
+                if(!waited) {
+                    m_NumFullWaits.fetch_add(1, std::memory_order_relaxed);
+                    waited = true;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                continue;
+            }
+
+            // Copy events into arena and publish batch
+            const size_t batch = head % m_NumBatches;
+            std::copy_n(m_Pending.data(), m_PendingCount, &m_Arena[offset % m_ArenaSize]);
+            m_Offsets[batch] = offset;
+            m_Counts[batch] = m_PendingCount;
+            m_ArenaHead = offset + m_PendingCount;
+            m_HasPending = false;
+            m_Head.store(head + 1, std::memory_order_release);
+        }
+    }
+
+    void stopThread()
+    {
+        if(m_Thread.joinable()) {
+            m_Stop = true;
+            m_Thread.join();
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    Source &m_Source;
+    const size_t m_NumBatches;
+    const size_t m_ArenaSize;
+    const std::chrono::duration<double, std::milli> m_Period;
+
+    // Ring of batches, each of which is m_Counts events starting at (unwrapped)
+    // m_Offsets within arena - head is only written by producer and tail by consumer
+    std::vector<unsigned int> m_Arena;
+    std::vector<size_t> m_Offsets;
+    std::vector<unsigned int> m_Counts;
+    alignas(64) std::atomic<size_t> m_Head;
+    alignas(64) std::atomic<size_t> m_Tail;
+
+    std::atomic<bool> m_Stop;
+    std::atomic<bool> m_SourceFinished;
+    std::atomic<size_t> m_NumFullWaits;
+    std::thread m_Thread;
+
+    // Producer state - batch read from source but not yet added to ring and
+    // (unwrapped) position in arena after end of newest batch
+    std::vector<unsigned int> m_Pending;
+    unsigned int m_PendingCount;
+    bool m_HasPending;
+    size_t m_ArenaHead;
+
+    // Consumer state
+    const unsigned int *m_Current;
+    size_t m_NumTicks;
+    size_t m_NumDryTicks;
+    size_t m_MinOccupancy;
+};
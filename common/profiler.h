@@ -0,0 +1,328 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Standard C includes
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+//------------------------------------------------------------------------
+// LatencyHistogram
+//------------------------------------------------------------------------
+//! Log-bucketed histogram of durations with ~2% relative precision. Fixed
+//! size so recording samples never allocates, however long we run for
+class LatencyHistogram
+{
+public:
+    LatencyHistogram() : m_Buckets(NumBuckets, 0), m_Count(0), m_Total(0.0), m_Max(0.0)
+    {
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    void record(double ns)
+    {
+        m_Buckets[getBucket(ns)]++;
+        m_Count++;
+        m_Total += ns;
+        m_Max = std::max(m_Max, ns);
+    }
+
+    //! Get upper bound (in ns) of bucket containing the p'th percentile (0 < p <= 1)
+    double getPercentile(double p) const
+    {
+        const uint64_t target = std::max<uint64_t>(1, (uint64_t)std::ceil(p * (double)m_Count));
+        uint64_t cumulative = 0;
+        for(size_t b = 0; b < NumBuckets; b++) {
+            cumulative += m_Buckets[b];
+            if(cumulative >= target) {
+                return std::min(m_Max, std::pow(Resolution, (double)(b + 1)));
+            }
+        }
+        return m_Max;
+    }
+
+    uint64_t getCount() const{ return m_Count; }
+    double getTotal() const{ return m_Total; }
+    double getMean() const{ return (m_Count == 0) ? 0.0 : (m_Total / (double)m_Count); }
+    double getMax() const{ return m_Max; }
+
+private:
+    //------------------------------------------------------------------------
+    // Constants
+    //------------------------------------------------------------------------
+    // Ratio between successive bucket boundaries and enough buckets to reach > 1000s
+    static constexpr double Resolution = 1.02;
+    static constexpr size_t NumBuckets = 1400;
+
+    //------------------------------------------------------------------------
+    // Private static methods
+    //------------------------------------------------------------------------
+    static size_t getBucket(double ns)
+    {
+        if(ns <= 1.0) {
+            return 0;
+        }
+        else {
+            return std::min(NumBuckets - 1, (size_t)(std::log(ns) / std::log(Resolution)));
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    std::vector<uint64_t> m_Buckets;
+    uint64_t m_Count;
+    double m_Total;
+    double m_Max;
+};
+
+//------------------------------------------------------------------------
+// Profiler
+//------------------------------------------------------------------------
+//! Hierarchical profiler. Scopes nest within each other and within ticks
+//! (typically simulation timesteps) delimited by beginTick and endTick.
+//! The time each scope takes in each tick is added to a histogram so p50,
+//! p99 and max latencies can be reported. Not thread-safe - use one per thread.
+//! Defining NO_PROFILING turns everything into empty inline functions.
+class Profiler
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+public:
+    Profiler(size_t maxTraceEvents = 0) : m_MaxTraceEvents(maxTraceEvents), m_CurrentNode(0)
+    {
+        // Add root node to represent entire tick
+        m_Nodes.emplace_back("tick", 0);
+        m_TraceEvents.reserve(maxTraceEvents);
+        m_Epoch = Clock::now();
+    }
+
+    //------------------------------------------------------------------------
+    // Scope
+    //------------------------------------------------------------------------
+    //! RAII object to time a named scope
+    class Scope
+    {
+    public:
+#ifdef NO_PROFILING
+        Scope(Profiler&, const char*)
+        {
+        }
+#else
+        Scope(Profiler &profiler, const char *name)
+            : m_Profiler(profiler), m_Node(profiler.pushScope(name)), m_Start(Clock::now())
+        {
+        }
+
+        ~Scope()
+        {
+            m_Profiler.popScope(m_Node, m_Start, Clock::now());
+        }
+
+    private:
+        //------------------------------------------------------------------------
+        // Members
+        //------------------------------------------------------------------------
+        Profiler &m_Profiler;
+        const size_t m_Node;
+        const Clock::time_point m_Start;
+#endif  // NO_PROFILING
+    };
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    void beginTick()
+    {
+#ifndef NO_PROFILING
+        m_TickStart = Clock::now();
+#endif
+    }
+
+    void endTick()
+    {
+#ifndef NO_PROFILING
+        const Clock::time_point tickEnd = Clock::now();
+        m_Nodes[0].tickTotal += getNs(m_TickStart, tickEnd);
+        m_Nodes[0].tickCalls++;
+        addTraceEvent(0, m_TickStart, tickEnd);
+
+        // Add the time each scope that ran this tick took to its histogram
+        for(auto &n : m_Nodes) {
+            if(n.tickCalls > 0) {
+                n.histogram.record(n.tickTotal);
+                n.calls += n.tickCalls;
+                n.tickTotal = 0.0;
+                n.tickCalls = 0;
+            }
+        }
+#endif
+    }
+
+    //! Print table of per-tick latencies for each scope
+    void printSummary(std::ostream &os = std::cout) const
+    {
+#ifndef NO_PROFILING
+        os << std::setw(40) << std::left << "Scope" << std::right
+            << std::setw(10) << "Ticks" << std::setw(12) << "Mean [ms]" << std::setw(12) << "p50 [ms]"
+            << std::setw(12) << "p99 [ms]" << std::setw(12) << "Max [ms]" << std::endl;
+        for(size_t n = 0; n < m_Nodes.size(); n++) {
+            const auto &h = m_Nodes[n].histogram;
+            os << std::setw(40) << std::left << getPath(n) << std::right << std::setw(10) << h.getCount()
+                << std::fixed << std::setprecision(4)
+                << std::setw(12) << h.getMean() / 1.0E6 << std::setw(12) << h.getPercentile(0.5) / 1.0E6
+                << std::setw(12) << h.getPercentile(0.99) / 1.0E6 << std::setw(12) << h.getMax() / 1.0E6 << std::endl;
+        }
+#else
+        (void)os;
+#endif
+    }
+
+    //! Write per-tick latency statistics for each scope to JSON file
+    void writeJSON(const std::string &filename) const
+    {
+#ifndef NO_PROFILING
+        std::ofstream stream(filename);
+        stream << "{\"scopes\":[" << std::endl;
+        for(size_t n = 0; n < m_Nodes.size(); n++) {
+            const auto &node = m_Nodes[n];
+            const auto &h = node.histogram;
+            stream << "  {\"name\":\"" << getPath(n) << "\",\"calls\":" << node.calls << ",\"ticks\":" << h.getCount()
+                << ",\"total_ms\":" << h.getTotal() / 1.0E6 << ",\"mean_ms\":" << h.getMean() / 1.0E6
+                << ",\"p50_ms\":" << h.getPercentile(0.5) / 1.0E6 << ",\"p99_ms\":" << h.getPercentile(0.99) / 1.0E6
+                << ",\"max_ms\":" << h.getMax() / 1.0E6 << "}" << ((n == (m_Nodes.size() - 1)) ? "" : ",") << std::endl;
+        }
+        stream << "]}" << std::endl;
+#else
+        (void)filename;
+#endif
+    }
+
+    //! Write the first maxTraceEvents scopes in Chrome trace event format (load in chrome://tracing)
+    void writeChromeTrace(const std::string &filename) const
+    {
+#ifndef NO_PROFILING
+        std::ofstream stream(filename);
+        stream << "{\"traceEvents\":[" << std::endl;
+        stream << std::fixed << std::setprecision(3);
+        for(size_t e = 0; e < m_TraceEvents.size(); e++) {
+            const auto &event = m_TraceEvents[e];
+            stream << "  {\"name\":\"" << m_Nodes[event.node].name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+                << ",\"ts\":" << event.startNs / 1.0E3 << ",\"dur\":" << event.durationNs / 1.0E3 << "}"
+                << ((e == (m_TraceEvents.size() - 1)) ? "" : ",") << std::endl;
+        }
+        stream << "]}" << std::endl;
+#else
+        (void)filename;
+#endif
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Node
+    //------------------------------------------------------------------------
+    struct Node
+    {
+        Node(const char *n, size_t p) : name(n), parent(p), tickTotal(0.0), tickCalls(0), calls(0)
+        {
+        }
+
+        const char *name;
+        size_t parent;
+        std::vector<size_t> children;
+
+        // Time spent in scope and number of calls during current tick
+        double tickTotal;
+        unsigned int tickCalls;
+
+        uint64_t calls;
+        LatencyHistogram histogram;
+    };
+
+    //------------------------------------------------------------------------
+    // TraceEvent
+    //------------------------------------------------------------------------
+    struct TraceEvent
+    {
+        size_t node;
+        double startNs;
+        double durationNs;
+    };
+
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    size_t pushScope(const char *name)
+    {
+        // Search children of current node for one with this name
+        // **NOTE** names are typically literals so compare pointers first
+        auto &children = m_Nodes[m_CurrentNode].children;
+        auto child = std::find_if(children.cbegin(), children.cend(),
+                                  [name, this](size_t c)
+                                  {
+                                      return (m_Nodes[c].name == name || strcmp(m_Nodes[c].name, name) == 0);
+                                  });
+
+        // If it's not found, add a new node
+        if(child == children.cend()) {
+            const size_t node = m_Nodes.size();
+            m_Nodes[m_CurrentNode].children.push_back(node);
+            m_Nodes.emplace_back(name, m_CurrentNode);
+            m_CurrentNode = node;
+        }
+        else {
+            m_CurrentNode = *child;
+        }
+        return m_CurrentNode;
+    }
+
+    void popScope(size_t node, Clock::time_point start, Clock::time_point end)
+    {
+        m_Nodes[node].tickTotal += getNs(start, end);
+        m_Nodes[node].tickCalls++;
+        addTraceEvent(node, start, end);
+
+        m_CurrentNode = m_Nodes[node].parent;
+    }
+
+    void addTraceEvent(size_t node, Clock::time_point start, Clock::time_point end)
+    {
+        if(m_TraceEvents.size() < m_MaxTraceEvents) {
+            m_TraceEvents.push_back({node, getNs(m_Epoch, start), getNs(start, end)});
+        }
+    }
+
+    std::string getPath(size_t node) const
+    {
+        return (node == 0) ? m_Nodes[0].name : (getPath(m_Nodes[node].parent) + "/" + m_Nodes[node].name);
+    }
+
+    //------------------------------------------------------------------------
+    // Private static methods
+    //------------------------------------------------------------------------
+    static double getNs(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    std::vector<Node> m_Nodes;
+    std::vector<TraceEvent> m_TraceEvents;
+    const size_t m_MaxTraceEvents;
+
+    size_t m_CurrentNode;
+    Clock::time_point m_Epoch;
+    Clock::time_point m_TickStart;
+};
@@ -0,0 +1,237 @@
+#pragma once
+
+// Standard C++ includes
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// Standard C includes
+#include <cstdint>
+
+// Common includes
+#include "profiler.h"
+
+//----------------------------------------------------------------------------
+// RealtimeLoop
+//----------------------------------------------------------------------------
+//! Paces a simulation loop against wall-clock time. Each tick has an absolute
+//! deadline, one period after the previous one, so unlike sleeping for whatever
+//! remains of each tick, timing errors don't accumulate. Ticks that finish early
+//! sleep until shortly before their deadline and busy-wait for the remainder;
+//! what happens when a tick finishes late is determined by the OverrunPolicy.
+//! How late ticks wake up and how far they overrun are recorded in histograms.
+class RealtimeLoop
+{
+    // **NOTE** steady_clock as, unlike high_resolution_clock, it's guaranteed to be monotonic
+    typedef std::chrono::steady_clock Clock;
+
+public:
+    //------------------------------------------------------------------------
+    // Enumerations
+    //------------------------------------------------------------------------
+    enum class OverrunPolicy
+    {
+        None,               //!< Restart schedule when late tick finishes, lost time is never made up
+        CatchUp,            //!< Run ticks back-to-back until back on schedule
+        SkipInput,          //!< Discard input for any whole periods which have been missed
+        DegradeRendering,   //!< Run ticks back-to-back without rendering until back on schedule
+    };
+
+    //------------------------------------------------------------------------
+    // Tick
+    //------------------------------------------------------------------------
+    //! What the caller should do this tick
+    struct Tick
+    {
+        unsigned int inputToSkip;   //!< Number of periods of input to discard before reading this tick's
+        bool render;                //!< Whether to render (or do any other work that can be dropped)
+    };
+
+    //! Ticks last dtMs / speed of wall-clock time; a speed of zero runs as fast as possible.
+    //! If ticks fall more than maxBacklog periods behind, the schedule is restarted whatever the policy
+    RealtimeLoop(double dtMs, double speed = 1.0, OverrunPolicy policy = OverrunPolicy::CatchUp,
+                 double busyWaitUs = 200.0, unsigned int maxBacklog = 100)
+    :   m_Paced(speed > 0.0), m_Period(m_Paced ? toClockDuration(dtMs / speed) : Clock::duration::zero()),
+        m_BusyWait(toClockDuration(busyWaitUs / 1000.0)), m_Policy(policy), m_MaxBacklog(maxBacklog),
+        m_InputToSkip(0), m_Behind(false), m_NumTicks(0), m_NumOverruns(0), m_NumSkippedInputs(0),
+        m_NumDegradedTicks(0), m_NumResyncs(0)
+    {
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Call at start of each tick; the first call starts the schedule
+    Tick beginTick()
+    {
+        if(m_NumTicks == 0) {
+            m_Start = Clock::now();
+            m_Deadline = m_Start + m_Period;
+        }
+
+        const Tick tick{m_InputToSkip, !(m_Behind && m_Policy == OverrunPolicy::DegradeRendering)};
+        if(!tick.render) {
+            m_NumDegradedTicks++;
+        }
+        m_InputToSkip = 0;
+        return tick;
+    }
+
+    //! Call at end of each tick to wait for its deadline
+    void endTick()
+    {
+        m_NumTicks++;
+        if(!m_Paced) {
+            return;
+        }
+
+        const Clock::time_point now = Clock::now();
+
+        // If we're early, sleep until shortly before deadline and then spin
+        // **NOTE** sleep_until typically wakes tens of microseconds late
+        if(now <= m_Deadline) {
+            const Clock::time_point wake = m_Deadline - m_BusyWait;
+            if(now < wake) {
+                std::this_thread::sleep_until(wake);
+            }
+            while(Clock::now() < m_Deadline) {
+            }
+
+            m_JitterHistogram.record(getNs(m_Deadline, Clock::now()));
+            m_Deadline += m_Period;
+            m_Behind = false;
+        }
+        // Otherwise, we've overrun
+        else {
+            m_OverrunHistogram.record(getNs(m_Deadline, now));
+            m_NumOverruns++;
+
+            // Calculate how many whole periods after this tick's deadline have also been missed
+            const uint64_t missed = (uint64_t)((now - m_Deadline) / m_Period);
+            m_Deadline += m_Period;
+
+            // If we're hopelessly behind or we're not trying to catch up, restart schedule from now
+            if(m_Policy == OverrunPolicy::None || missed > m_MaxBacklog) {
+                m_Deadline = now + m_Period;
+                m_Behind = false;
+                m_NumResyncs++;
+            }
+            // Otherwise, if we're skipping input, drop missed periods from schedule
+            else if(m_Policy == OverrunPolicy::SkipInput) {
+                m_Deadline += m_Period * missed;
+                m_InputToSkip = (unsigned int)missed;
+                m_NumSkippedInputs += missed;
+            }
+            // Otherwise, keep schedule and let following ticks run back-to-back
+            else {
+                m_Behind = (m_Deadline < now);
+            }
+        }
+    }
+
+    uint64_t getNumTicks() const{ return m_NumTicks; }
+    uint64_t getNumOverruns() const{ return m_NumOverruns; }
+    uint64_t getNumSkippedInputs() const{ return m_NumSkippedInputs; }
+    uint64_t getNumDegradedTicks() const{ return m_NumDegradedTicks; }
+    uint64_t getNumResyncs() const{ return m_NumResyncs; }
+
+    //! Get wall-clock time since first tick began (ms)
+    double getElapsedMs() const
+    {
+        return (m_NumTicks == 0) ? 0.0 : (getNs(m_Start, Clock::now()) / 1.0E6);
+    }
+
+    //! Histogram of how late (ns) ticks that finished early woke up after their deadline
+    const LatencyHistogram &getJitterHistogram() const{ return m_JitterHistogram; }
+
+    //! Histogram of how late (ns) ticks that overran finished after their deadline
+    const LatencyHistogram &getOverrunHistogram() const{ return m_OverrunHistogram; }
+
+    void printSummary(std::ostream &os = std::cout) const
+    {
+        os << "Ran " << m_NumTicks << " ticks in " << getElapsedMs() << "ms: " << m_NumOverruns << " overran, "
+            << m_NumSkippedInputs << " inputs skipped, " << m_NumDegradedTicks << " ticks not rendered, "
+            << m_NumResyncs << " schedule restarts" << std::endl;
+
+        os << std::setw(10) << std::left << "" << std::right << std::setw(10) << "Ticks" << std::setw(12) << "Mean [ms]"
+            << std::setw(12) << "p50 [ms]" << std::setw(12) << "p99 [ms]" << std::setw(12) << "Max [ms]" << std::endl;
+        printHistogram(os, "Jitter", m_JitterHistogram);
+        printHistogram(os, "Overrun", m_OverrunHistogram);
+    }
+
+    //------------------------------------------------------------------------
+    // Static API
+    //------------------------------------------------------------------------
+    static OverrunPolicy parseOverrunPolicy(const std::string &name)
+    {
+        if(name == "none") {
+            return OverrunPolicy::None;
+        }
+        else if(name == "catchup") {
+            return OverrunPolicy::CatchUp;
+        }
+        else if(name == "skip") {
+            return OverrunPolicy::SkipInput;
+        }
+        else if(name == "degrade") {
+            return OverrunPolicy::DegradeRendering;
+        }
+        else {
+            throw std::runtime_error("Unknown overrun policy '" + name + "' - expected none, catchup, skip or degrade");
+        }
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Private static methods
+    //------------------------------------------------------------------------
+    static Clock::duration toClockDuration(double ms)
+    {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(ms));
+    }
+
+    static double getNs(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    static void printHistogram(std::ostream &os, const char *name, const LatencyHistogram &h)
+    {
+        const std::ios_base::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision();
+        os << std::setw(10) << std::left << name << std::right << std::setw(10) << h.getCount()
+            << std::fixed << std::setprecision(4)
+            << std::setw(12) << h.getMean() / 1.0E6 << std::setw(12) << h.getPercentile(0.5) / 1.0E6
+            << std::setw(12) << h.getPercentile(0.99) / 1.0E6 << std::setw(12) << h.getMax() / 1.0E6 << std::endl;
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const bool m_Paced;
+    const Clock::duration m_Period;
+    const Clock::duration m_BusyWait;
+    const OverrunPolicy m_Policy;
+    const unsigned int m_MaxBacklog;
+
+    Clock::time_point m_Start;
+    Clock::time_point m_Deadline;
+
+    // Input to skip at start of next tick and whether next tick is already late
+    unsigned int m_InputToSkip;
+    bool m_Behind;
+
+    uint64_t m_NumTicks;
+    uint64_t m_NumOverruns;
+    uint64_t m_NumSkippedInputs;
+    uint64_t m_NumDegradedTicks;
+    uint64_t m_NumResyncs;
+
+    LatencyHistogram m_JitterHistogram;
+    LatencyHistogram m_OverrunHistogram;
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+// Standard C++ includes
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+// Standard C includes
+#include <cassert>
+
+// Common includes
+#include "connectors.h"
+
+//----------------------------------------------------------------------------
+// RetinotopicRect
+//----------------------------------------------------------------------------
+//! Rectangular region of a row-major 2D population
+struct RetinotopicRect
+{
+    unsigned int x;
+    unsigned int y;
+    unsigned int width;
+    unsigned int height;
+};
+
+//----------------------------------------------------------------------------
+// StencilOffset
+//----------------------------------------------------------------------------
+//! Offset from a presynaptic neuron to the postsynaptic cell it connects to
+//! and the channel within that cell (e.g. which of several detectors)
+struct StencilOffset
+{
+    int x;
+    int y;
+    unsigned int channel;
+};
+
+//----------------------------------------------------------------------------
+// Functions
+//----------------------------------------------------------------------------
+// All of these builders calculate the number of synapses analytically and
+// then write each synaptic row straight into the projection in a single pass
+inline RetinotopicRect getCentredRect(unsigned int width, unsigned int height,
+                                      unsigned int centreWidth, unsigned int centreHeight)
+{
+    assert(centreWidth <= width && centreHeight <= height);
+    return RetinotopicRect{(width - centreWidth) / 2, (height - centreHeight) / 2, centreWidth, centreHeight};
+}
+
+inline void buildOneToOneConnector(unsigned int numNeurons, SparseProjection &projection, AllocateFn allocate)
+{
+    // Allocate one connection per neuron
+    allocate(numNeurons);
+
+    for(unsigned int i = 0; i < numNeurons; i++) {
+        projection.indInG[i] = i;
+        projection.ind[i] = i;
+    }
+
+    projection.indInG[numNeurons] = numNeurons;
+}
+
+//! Connect each kernelWidth * kernelHeight block of pixels within centred region
+//! of presynaptic population to one neuron of a (centreWidth / kernelWidth) wide
+//! postsynaptic population
+inline void buildPoolingConnector(unsigned int preWidth, unsigned int preHeight,
+                                  unsigned int centreWidth, unsigned int centreHeight,
+                                  unsigned int kernelWidth, unsigned int kernelHeight,
+                                  SparseProjection &projection, AllocateFn allocate)
+{
+    if((centreWidth % kernelWidth) != 0 || (centreHeight % kernelHeight) != 0) {
+        throw std::runtime_error("Pooling kernel must evenly divide centre region");
+    }
+
+    // Allocate one connection per pixel in centre
+    allocate(centreWidth * centreHeight);
+
+    const RetinotopicRect centre = getCentredRect(preWidth, preHeight, centreWidth, centreHeight);
+    const unsigned int postWidth = centreWidth / kernelWidth;
+
+    // Loop through presynaptic pixels
+    unsigned int s = 0;
+    unsigned int i = 0;
+    for(unsigned int yi = 0; yi < preHeight; yi++) {
+        const bool rowInCentre = (yi >= centre.y && yi < (centre.y + centre.height));
+        for(unsigned int xi = 0; xi < preWidth; xi++) {
+            projection.indInG[i++] = s;
+
+            // If we're in the centre, connect to neuron pooling this pixel's block
+            if(rowInCentre && xi >= centre.x && xi < (centre.x + centre.width)) {
+                const unsigned int xj = (xi - centre.x) / kernelWidth;
+                const unsigned int yj = (yi - centre.y) / kernelHeight;
+                projection.ind[s++] = xj + (yj * postWidth);
+            }
+        }
+    }
+
+    // Add ending entry to data structure
+    projection.indInG[i] = s;
+
+    // Check
+    assert(s == (centreWidth * centreHeight));
+}
+
+//! Connect every pixel within centred region of presynaptic population to a single neuron
+inline void buildCentreToOneConnector(unsigned int preWidth, unsigned int preHeight,
+                                      unsigned int centreWidth, unsigned int centreHeight,
+                                      SparseProjection &projection, AllocateFn allocate)
+{
+    buildPoolingConnector(preWidth, preHeight, centreWidth, centreHeight, centreWidth, centreHeight,
+                          projection, allocate);
+}
+
+//! Connect each presynaptic neuron at (x, y) to channel c of the postsynaptic cell at
+//! (x + offset.x, y + offset.y) for each offset in stencil, if that cell lies within
+//! postRegion. Postsynaptic cells are row-major with numChannels neurons per cell
+//! and synapses within each row are ordered as in stencil
+inline void buildStencilConnector(unsigned int preWidth, unsigned int preHeight,
+                                  unsigned int postWidth, const RetinotopicRect &postRegion,
+                                  unsigned int numChannels, const std::vector<StencilOffset> &stencil,
+                                  SparseProjection &projection, AllocateFn allocate)
+{
+    // Get number of presynaptic coordinates in [0, preSize) which, when offset, lie in [begin, end)
+    auto getOverlap =
+        [](unsigned int preSize, int offset, unsigned int begin, unsigned int end)
+        {
+            const int first = std::max(0, (int)begin - offset);
+            const int last = std::min((int)preSize, (int)end - offset);
+            return (unsigned int)std::max(0, last - first);
+        };
+
+    // Count synapses and allocate
+    unsigned int numSynapses = 0;
+    for(const auto &o : stencil) {
+        assert(o.channel < numChannels);
+        numSynapses += getOverlap(preWidth, o.x, postRegion.x, postRegion.x + postRegion.width)
+            * getOverlap(preHeight, o.y, postRegion.y, postRegion.y + postRegion.height);
+    }
+    allocate(numSynapses);
+
+    // Loop through presynaptic neurons
+    const int postRegionEndX = (int)(postRegion.x + postRegion.width);
+    const int postRegionEndY = (int)(postRegion.y + postRegion.height);
+    unsigned int s = 0;
+    unsigned int i = 0;
+    for(unsigned int yi = 0; yi < preHeight; yi++) {
+        for(unsigned int xi = 0; xi < preWidth; xi++) {
+            projection.indInG[i++] = s;
+
+            // Add synapses to each offset cell within region
+            for(const auto &o : stencil) {
+                const int xj = (int)xi + o.x;
+                const int yj = (int)yi + o.y;
+                if(xj >= (int)postRegion.x && xj < postRegionEndX && yj >= (int)postRegion.y && yj < postRegionEndY) {
+                    projection.ind[s++] = (((unsigned int)yj * postWidth) + (unsigned int)xj) * numChannels + o.channel;
+                }
+            }
+        }
+    }
+
+    // Add ending entry to data structure
+    projection.indInG[i] = s;
+
+    // Check
+    assert(s == numSynapses);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+// Standard C includes
+#include <cstdint>
+#include <cstring>
+
+// Common includes
+#include "background_file_writer.h"
+
+//----------------------------------------------------------------------------
+// SpikeBinaryRecorderBase
+//----------------------------------------------------------------------------
+//! Writes spikes in a compact binary format, via a BackgroundFileWriter, so
+//! recording doesn't format text or touch the disk on the simulation thread.
+//! File starts with the 8 byte magic "GENNSPK1" followed, for each timestep
+//! with spikes, by a double time, a uint32 spike count and uint32 neuron IDs.
+//! Use spike_binary_to_csv.py to convert to the SpikeCSVRecorder layout.
+class SpikeBinaryRecorderBase
+{
+protected:
+    SpikeBinaryRecorderBase(const char *filename, size_t bufferBytes)
+    :   m_Writer(filename, bufferBytes)
+    {
+        m_Writer.write("GENNSPK1", 8);
+    }
+
+    //------------------------------------------------------------------------
+    // Protected methods
+    //------------------------------------------------------------------------
+    void recordSpikes(double t, unsigned int spikeCount, const unsigned int *spikes)
+    {
+        // Timesteps without spikes don't produce any rows in the CSV so skip them
+        if(spikeCount == 0) {
+            return;
+        }
+
+        static_assert(sizeof(unsigned int) == sizeof(uint32_t), "Spike IDs must be 32-bit");
+
+        // Copy time, count and IDs into writer's buffer
+        const size_t spikeBytes = sizeof(uint32_t) * spikeCount;
+        char *data = m_Writer.reserve(sizeof(double) + sizeof(uint32_t) + spikeBytes);
+        std::memcpy(data, &t, sizeof(double));
+        std::memcpy(data + sizeof(double), &spikeCount, sizeof(uint32_t));
+        std::memcpy(data + sizeof(double) + sizeof(uint32_t), spikes, spikeBytes);
+    }
+
+private:
+    //----------------------------------------------------------------------------
+    // Members
+    //----------------------------------------------------------------------------
+    BackgroundFileWriter m_Writer;
+};
+
+//----------------------------------------------------------------------------
+// SpikeBinaryRecorder
+//----------------------------------------------------------------------------
+class SpikeBinaryRecorder : public SpikeBinaryRecorderBase
+{
+public:
+    SpikeBinaryRecorder(const char *filename, unsigned int *spkCnt, unsigned int *spk,
+                        size_t bufferBytes = 1024 * 1024)
+    : SpikeBinaryRecorderBase(filename, bufferBytes), m_SpkCnt(spkCnt), m_Spk(spk)
+    {
+    }
+
+    void record(double t)
+    {
+        recordSpikes(t, m_SpkCnt[0], m_Spk);
+    }
+
+private:
+    //----------------------------------------------------------------------------
+    // Members
+    //----------------------------------------------------------------------------
+    unsigned int *m_SpkCnt;
+    unsigned int *m_Spk;
+};
+
+//----------------------------------------------------------------------------
+// SpikeBinaryRecorderDelay
+//----------------------------------------------------------------------------
+class SpikeBinaryRecorderDelay : public SpikeBinaryRecorderBase
+{
+public:
+    SpikeBinaryRecorderDelay(const char *filename, unsigned int popSize, unsigned int &spkQueuePtr,
+                             unsigned int *spkCnt, unsigned int *spk, size_t bufferBytes = 1024 * 1024)
+    : SpikeBinaryRecorderBase(filename, bufferBytes), m_SpkQueuePtr(spkQueuePtr), m_SpkCnt(spkCnt), m_Spk(spk), m_PopSize(popSize)
+    {
+    }
+
+    void record(double t)
+    {
+        recordSpikes(t, m_SpkCnt[m_SpkQueuePtr], &m_Spk[m_SpkQueuePtr * m_PopSize]);
+    }
+
+private:
+    //----------------------------------------------------------------------------
+    // Members
+    //----------------------------------------------------------------------------
+    unsigned int &m_SpkQueuePtr;
+    unsigned int *m_SpkCnt;
+    unsigned int *m_Spk;
+    unsigned int m_PopSize;
+};
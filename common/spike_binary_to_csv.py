@@ -0,0 +1,30 @@
+import struct
+import sys
+
+# Converts spikes written by SpikeBinaryRecorder into the
+# layout written by SpikeCSVRecorder so plotting scripts can read them
+# Usage: python spike_binary_to_csv.py spikes.bin spikes.csv
+if len(sys.argv) != 3:
+    print("Usage: %s input.bin output.csv" % sys.argv[0])
+    sys.exit(1)
+
+header_struct = struct.Struct("<dI")
+
+with open(sys.argv[1], "rb") as binary_file, open(sys.argv[2], "w") as csv_file:
+    if binary_file.read(8) != b"GENNSPK1":
+        print("%s is not a binary spike file" % sys.argv[1])
+        sys.exit(1)
+
+    csv_file.write("Time [ms], Neuron ID\n")
+
+    while True:
+        # Read time and spike count
+        header = binary_file.read(header_struct.size)
+        if len(header) < header_struct.size:
+            break
+        time, count = header_struct.unpack(header)
+
+        # Read spike IDs and write one row per spike
+        ids = struct.unpack("<%uI" % count, binary_file.read(4 * count))
+        time_string = "%g" % time
+        csv_file.writelines("%s,%u\n" % (time_string, i) for i in ids)
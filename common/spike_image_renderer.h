@@ -1,6 +1,10 @@
 #pragma once
 
+// Standard C++ includes
+#include <vector>
+
 // Standard C includes
+#include <cstdint>
 #include <cstdlib>
 
 // OpenCV includes
@@ -22,4 +26,85 @@ inline void renderSpikeImage(unsigned int spikeCount, const unsigned int *spikes
 
     // Decay image
     image *= persistence;
-}
\ No newline at end of file
+}
+
+//----------------------------------------------------------------------------
+// LazySpikeImageRenderer
+//----------------------------------------------------------------------------
+//! Produces the same decaying image as renderSpikeImage but, rather than
+//! decaying every pixel every timestep, stores each pixel's value and the
+//! timestep it was last updated. Pixels are only decayed when they spike or
+//! when render is called so the cost of each timestep scales with the number
+//! of spikes rather than the size of the image.
+class LazySpikeImageRenderer
+{
+public:
+    LazySpikeImageRenderer(unsigned int width, unsigned int height, float persistence)
+    :   m_Width(width), m_Height(height), m_Values(width * height, 0.0f), m_LastUpdate(width * height, 0),
+        m_Timestep(0)
+    {
+        // Tabulate powers of persistence until they become negligible
+        // **NOTE** pixels which haven't been updated for longer than this are treated as zero
+        for(float p = 1.0f; p > 1.0E-6f && m_Decay.size() < 1000000; p *= persistence) {
+            m_Decay.push_back(p);
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Add this timestep's spikes and advance to the next timestep
+    void addSpikes(unsigned int spikeCount, const unsigned int *spikes)
+    {
+        for(unsigned int s = 0; s < spikeCount; s++) {
+            const unsigned int spike = spikes[s];
+
+            // If pixel hasn't already been updated this timestep, bring its value up to date
+            if(m_LastUpdate[spike] != m_Timestep) {
+                m_Values[spike] *= getDecay(m_Timestep - m_LastUpdate[spike]);
+                m_LastUpdate[spike] = m_Timestep;
+            }
+            m_Values[spike] += 1.0f;
+        }
+
+        m_Timestep++;
+    }
+
+    //! Render decayed value of every pixel into 32-bit float image
+    void render(cv::Mat &image) const
+    {
+        image.create(m_Height, m_Width, CV_32F);
+        for(unsigned int y = 0; y < m_Height; y++) {
+            float *row = image.ptr<float>(y);
+            const unsigned int rowStart = y * m_Width;
+            for(unsigned int x = 0; x < m_Width; x++) {
+                // **NOTE** values are stored before the decay applied at the end of the timestep they were updated
+                const unsigned int i = rowStart + x;
+                row[x] = m_Values[i] * getDecay(m_Timestep - m_LastUpdate[i]);
+            }
+        }
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    float getDecay(uint32_t timesteps) const
+    {
+        return (timesteps < m_Decay.size()) ? m_Decay[timesteps] : 0.0f;
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const unsigned int m_Width;
+    const unsigned int m_Height;
+
+    // Value of each pixel and timestep it was last updated
+    std::vector<float> m_Values;
+    std::vector<uint32_t> m_LastUpdate;
+    uint32_t m_Timestep;
+
+    // Persistence raised to the power of each number of timesteps
+    std::vector<float> m_Decay;
+};
@@ -0,0 +1,179 @@
+#pragma once
+
+// Standard C++ includes
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Standard C includes
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+//----------------------------------------------------------------------------
+// TimestepSpikeReader
+//----------------------------------------------------------------------------
+//! Reads spike files consisting of 'timestep;id,id,...' lines (as used by the
+//! qian_dataset recordings) through a read-ahead buffer with a hand-written
+//! integer scanner so no strings or streams are allocated per line or per spike.
+//! IDs can optionally be mapped through a lookup table as they are read e.g.
+//! to downsample them to a lower resolution. Reading stops at an empty line.
+class TimestepSpikeReader
+{
+public:
+    TimestepSpikeReader(const std::string &filename, const std::vector<unsigned int> &remap = {},
+                        size_t bufferBytes = 64 * 1024)
+    :   m_Filename(filename), m_File(fopen(filename.c_str(), "rb")), m_Remap(remap), m_Buffer(bufferBytes),
+        m_Position(0), m_End(0)
+    {
+        if(m_File == nullptr) {
+            throw std::runtime_error("Cannot open spike file '" + filename + "'");
+        }
+    }
+
+    TimestepSpikeReader(const TimestepSpikeReader&) = delete;
+    TimestepSpikeReader &operator=(const TimestepSpikeReader&) = delete;
+
+    ~TimestepSpikeReader()
+    {
+        fclose(m_File);
+    }
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Read next line into timestep and ids, returning false if there are no more
+    bool readNext(unsigned int &timestep, std::vector<unsigned int> &ids)
+    {
+        ids.clear();
+
+        // If we've reached the end of the file or an empty line, stop
+        int c = peekChar();
+        if(c == EOF || c == '\n' || c == '\r') {
+            return false;
+        }
+
+        // Read timestep
+        timestep = readUnsigned();
+        if(getChar() != ';') {
+            throw std::runtime_error("Expected ';' after timestep in '" + m_Filename + "'");
+        }
+
+        // Read comma-separated IDs until end of line
+        while(true) {
+            c = peekChar();
+            if(c == EOF || c == '\n' || c == '\r') {
+                break;
+            }
+
+            const unsigned int id = readUnsigned();
+            if(m_Remap.empty()) {
+                ids.push_back(id);
+            }
+            else if(id < m_Remap.size()) {
+                ids.push_back(m_Remap[id]);
+            }
+            else {
+                throw std::runtime_error("Spike ID " + std::to_string(id) + " out of range in '" + m_Filename + "'");
+            }
+
+            // Skip separator
+            if(peekChar() == ',') {
+                getChar();
+            }
+        }
+
+        // Skip line ending
+        if(peekChar() == '\r') {
+            getChar();
+        }
+        if(peekChar() == '\n') {
+            getChar();
+        }
+        return true;
+    }
+
+    //! Seek to byte offset (e.g. from DVSEventIndex) in file
+    void seek(uint64_t offset)
+    {
+        fseek(m_File, (long)offset, SEEK_SET);
+        m_Position = 0;
+        m_End = 0;
+    }
+
+    //------------------------------------------------------------------------
+    // Static API
+    //------------------------------------------------------------------------
+    //! Create remap table which scales IDs of a square originalResolution population
+    //! to a square outputResolution population
+    static std::vector<unsigned int> createDownsampleRemap(unsigned int originalResolution, unsigned int outputResolution)
+    {
+        const double scale = (double)originalResolution / (double)outputResolution;
+
+        std::vector<unsigned int> remap(originalResolution * originalResolution);
+        for(unsigned int i = 0; i < originalResolution; i++) {
+            const unsigned int outputI = (unsigned int)std::floor((double)i / scale);
+            for(unsigned int j = 0; j < originalResolution; j++) {
+                const unsigned int outputJ = (unsigned int)std::floor((double)j / scale);
+                remap[(i * originalResolution) + j] = (outputI * outputResolution) + outputJ;
+            }
+        }
+        return remap;
+    }
+
+private:
+    //------------------------------------------------------------------------
+    // Private methods
+    //------------------------------------------------------------------------
+    int peekChar()
+    {
+        if(m_Position == m_End && !refill()) {
+            return EOF;
+        }
+        return (unsigned char)m_Buffer[m_Position];
+    }
+
+    int getChar()
+    {
+        const int c = peekChar();
+        if(c != EOF) {
+            m_Position++;
+        }
+        return c;
+    }
+
+    unsigned int readUnsigned()
+    {
+        int c = peekChar();
+        if(c < '0' || c > '9') {
+            throw std::runtime_error("Expected integer in '" + m_Filename + "'");
+        }
+
+        unsigned int value = 0;
+        do {
+            value = (value * 10) + (unsigned int)(c - '0');
+            m_Position++;
+            c = peekChar();
+        } while(c >= '0' && c <= '9');
+        return value;
+    }
+
+    bool refill()
+    {
+        m_Position = 0;
+        m_End = fread(m_Buffer.data(), 1, m_Buffer.size(), m_File);
+        return (m_End > 0);
+    }
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    const std::string m_Filename;
+    FILE *m_File;
+    const std::vector<unsigned int> m_Remap;
+
+    // Read-ahead buffer and position of next and end characters within it
+    std::vector<char> m_Buffer;
+    size_t m_Position;
+    size_t m_End;
+};
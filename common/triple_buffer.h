@@ -0,0 +1,82 @@
+#pragma once
+
+// Standard C++ includes
+#include <atomic>
+
+// Standard C includes
+#include <cstdint>
+
+//----------------------------------------------------------------------------
+// TripleBuffer
+//----------------------------------------------------------------------------
+//! Lock-free handoff of snapshots from one writer thread to one reader thread.
+//! The writer fills getWriteBuffer() and calls publish() which never waits;
+//! the reader calls update() to take the latest published snapshot (if any)
+//! and then reads getReadBuffer() for as long as it likes. Snapshots
+//! published while the reader is busy are simply replaced by newer ones.
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : m_Buffers(), m_Write(0), m_Shared(1), m_Read(2)
+    {
+    }
+
+    //! Construct each buffer as T(args...) e.g. to give cv::Mat separate storage
+    template<typename... Args>
+    explicit TripleBuffer(const Args&... args) : m_Write(0), m_Shared(1), m_Read(2)
+    {
+        for(auto &b : m_Buffers) {
+            b = T(args...);
+        }
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer &operator=(const TripleBuffer&) = delete;
+
+    //------------------------------------------------------------------------
+    // Public API
+    //------------------------------------------------------------------------
+    //! Buffer for writer thread to fill with next snapshot
+    T &getWriteBuffer(){ return m_Buffers[m_Write]; }
+
+    //! Make write buffer available to reader and start writing to another
+    void publish()
+    {
+        // Swap write buffer with shared buffer, marking it as fresh
+        m_Write = m_Shared.exchange(m_Write | FreshBit, std::memory_order_acq_rel) & IndexMask;
+    }
+
+    //! Swap in latest published snapshot, returning false if nothing new has been published
+    bool update()
+    {
+        // If nothing has been published since last update, keep current read buffer
+        if((m_Shared.load(std::memory_order_relaxed) & FreshBit) == 0) {
+            return false;
+        }
+
+        // Swap read buffer with shared buffer
+        m_Read = m_Shared.exchange(m_Read, std::memory_order_acq_rel) & IndexMask;
+        return true;
+    }
+
+    //! Buffer containing latest snapshot taken by update
+    const T &getReadBuffer() const{ return m_Buffers[m_Read]; }
+
+private:
+    //------------------------------------------------------------------------
+    // Constants
+    //------------------------------------------------------------------------
+    static constexpr uint8_t IndexMask = 3;
+    static constexpr uint8_t FreshBit = 4;
+
+    //------------------------------------------------------------------------
+    // Members
+    //------------------------------------------------------------------------
+    T m_Buffers[3];
+
+    // Index of buffer owned by writer, shared between threads and owned by reader
+    uint8_t m_Write;
+    std::atomic<uint8_t> m_Shared;
+    uint8_t m_Read;
+};
@@ -29,6 +29,10 @@ namespace Parameters
     // connection probability
     constexpr double probabilityConnection = 0.1;
 
+    // Seed used to build connectivity and generate stimuli and input
+    // **NOTE** fixed so runs are reproducible
+    constexpr unsigned int seed = 1234;
+
     // input sets
     constexpr unsigned int numStimuliSets = 100;
     constexpr unsigned int stimuliSetSize = 50;
@@ -10,7 +10,7 @@
 #endif  // CPU_ONLY
 
 // Common includes
-#include "../common/connectors.h"
+#include "../common/connectivity_cache.h"
 #include "../common/spike_csv_recorder.h"
 #include "../common/timer.h"
 
@@ -65,7 +65,8 @@ std::pair<float, float> getMeanOutgoingWeight(const SparseProjection &projection
 
 int main()
 {
-    std::mt19937 gen;
+    // Generate stimuli and input using a seed distinct from those used for connectivity
+    std::mt19937 gen(Parameters::seed + 4);
 
     {
         Timer<> t("Allocation:");
@@ -79,14 +80,18 @@ int main()
 
     {
         Timer<> t("Building connectivity:");
-        buildFixedProbabilityConnector(Parameters::numInhibitory, Parameters::numInhibitory,
-                                    Parameters::probabilityConnection, CII, &allocateII, gen);
-        buildFixedProbabilityConnector(Parameters::numInhibitory, Parameters::numExcitatory,
-                                    Parameters::probabilityConnection, CIE, &allocateIE, gen);
-        buildFixedProbabilityConnector(Parameters::numExcitatory, Parameters::numExcitatory,
-                                    Parameters::probabilityConnection, CEE, &allocateEE, gen);
-        buildFixedProbabilityConnector(Parameters::numExcitatory, Parameters::numInhibitory,
-                                    Parameters::probabilityConnection, CEI, &allocateEI, gen);
+        buildFixedProbabilityConnectorCached(Parameters::numInhibitory, Parameters::numInhibitory,
+                                             Parameters::probabilityConnection, CII, &allocateII,
+                                             Parameters::seed);
+        buildFixedProbabilityConnectorCached(Parameters::numInhibitory, Parameters::numExcitatory,
+                                             Parameters::probabilityConnection, CIE, &allocateIE,
+                                             Parameters::seed + 1);
+        buildFixedProbabilityConnectorCached(Parameters::numExcitatory, Parameters::numExcitatory,
+                                             Parameters::probabilityConnection, CEE, &allocateEE,
+                                             Parameters::seed + 2);
+        buildFixedProbabilityConnectorCached(Parameters::numExcitatory, Parameters::numInhibitory,
+                                             Parameters::probabilityConnection, CEI, &allocateEI,
+                                             Parameters::seed + 3);
     }
 
     {
@@ -48,18 +48,15 @@ def read_input_spikes(filename, num_frames):
         return timestep_inputs
 
 def read_s_voltage():
-    with open("s_voltages.csv", "rb") as s_v_file:
-        # Create CSV reader
-        s_v_csv_reader = csv.reader(s_v_file, delimiter = ",")
-
-        # Skip headers
-        s_v_csv_reader.next()
-
-        # Read data and zip into columns
-        s_v_columns = zip(*s_v_csv_reader)
-
-        # Convert CSV columns to numpy
-        s_v = np.asarray(s_v_columns[2], dtype=float)
+    with open("s_voltages.bin", "rb") as s_v_file:
+        # Read AnalogueBinaryRecorder header
+        assert s_v_file.read(8) == b"GENNANA1"
+        num_neurons, value_bytes, interval, mode = np.fromfile(s_v_file, dtype=np.uint32, count=4)
+        assert value_bytes == 4 and mode == 0
+        np.fromfile(s_v_file, dtype=np.uint32, count=num_neurons)
+
+        # Read rows of time followed by voltage of each neuron
+        s_v = np.fromfile(s_v_file, dtype=[("time", np.float64), ("v", np.float32, int(num_neurons))])["v"]
 
         # Build 3D histogram i.e. video frames from this data
         return  np.reshape(s_v, (-1, output_resolution, output_resolution))
@@ -7,6 +7,10 @@ namespace Parameters
 {
     const double timestep = 1.0;
 
+    // How often to render input and output images for display (timesteps)
+    // **NOTE** cv::waitKey alone takes over a timestep so rendering every timestep would always overrun
+    const unsigned int renderInterval = 33;
+
     const unsigned int input_size = 32;
     const unsigned int centre_size = 20;
 
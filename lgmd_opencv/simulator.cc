@@ -14,7 +14,9 @@
 
 // Common example code
 #include "../common/opencv_dvs.h"
-#include "../common/timer.h"
+#include "../common/profiler.h"
+#include "../common/realtime_loop.h"
+#include "../common/retinotopic_connectors.h"
 
 // LGMD includes
 #include "parameters.h"
@@ -26,14 +28,6 @@
 //----------------------------------------------------------------------------
 namespace
 {
-typedef void (*allocateFn)(unsigned int);
-typedef TimerAccumulate<std::chrono::microseconds>  ProfilingTimer;
-
-unsigned int get_neuron_index(unsigned int resolution, unsigned int x, unsigned int y)
-{
-    return x + (y * resolution);
-}
-
 void print_sparse_matrix(unsigned int pre_resolution, const SparseProjection &projection)
 {
     const unsigned int pre_size = pre_resolution * pre_resolution;
@@ -50,133 +44,6 @@ void print_sparse_matrix(unsigned int pre_resolution, const SparseProjection &pr
     }
 }
 
-void build_one_to_one_connection(unsigned int resolution,
-                                 SparseProjection &projection, allocateFn allocate)
-{
-    // Allocate one connection per neuron
-    const unsigned int pop_size = resolution * resolution;
-    allocate(pop_size);
-
-    for(unsigned int i = 0; i < pop_size; i++)
-    {
-        projection.indInG[i] = i;
-        projection.ind[i] = i;
-    }
-
-    projection.indInG[pop_size] = pop_size;
-}
-
-void build_centre_to_one_connection(unsigned int pre_resolution, unsigned int centre_size,
-                                    SparseProjection &projection, allocateFn allocate)
-{
-    // Allocate centre_size * centre_size connections
-    allocate(centre_size * centre_size);
-
-    // Calculate start and end of border on each row
-    const unsigned int border_size = (pre_resolution - centre_size) / 2;
-    const unsigned int far_border = pre_resolution - border_size;
-
-    // Loop through rows of pixels in centre
-    unsigned int s = 0;
-    unsigned int i = 0;
-    for(unsigned int yi = 0; yi < pre_resolution; yi++)
-    {
-        for(unsigned int xi = 0; xi < pre_resolution; xi++)
-        {
-            projection.indInG[i++] = s;
-
-            // If we're in the centre
-            if(xi >= border_size && xi < far_border && yi >= border_size && yi < far_border) {
-                projection.ind[s++] = 0;
-            }
-        }
-    }
-
-    // Add ending entry to data structure
-    projection.indInG[i] = s;
-
-    // Check
-    assert(s == (centre_size * centre_size));
-    assert(i == (pre_resolution * pre_resolution));
-}
-
-void build_i_s_connections(unsigned int resolution, unsigned int centre_size,
-                           SparseProjection &projection1, allocateFn allocate1,
-                           SparseProjection &projection2, allocateFn allocate2,
-                           SparseProjection &projection4, allocateFn allocate4)
-{
-    const unsigned int pop_size = resolution * resolution;
-    
-    // Allocate sparse projections
-    allocate1(centre_size * centre_size * 4);
-    allocate2(centre_size * centre_size * 4);
-    allocate4(centre_size * centre_size * 4);
-
-    // Calculate start and end of border on each row
-    const unsigned int border_size = (resolution - centre_size) / 2;
-    const unsigned int far_border = resolution - border_size;
-
-    // Create temporary vectors to hold rows
-    std::vector<std::vector<unsigned int>> projection1Map(pop_size);
-    std::vector<std::vector<unsigned int>> projection2Map(pop_size);
-    std::vector<std::vector<unsigned int>> projection4Map(pop_size);
-
-    // Loop through POSTsynaptic neurons
-    for(unsigned int xj =  border_size; xj < far_border; xj++)
-    {
-        for(unsigned int yj = border_size; yj < far_border; yj++)
-        {
-            const unsigned int j = get_neuron_index(resolution, xj, yj);
-
-            // Add adjacent neighbours to projection 1
-            projection1Map[get_neuron_index(resolution, xj - 1, yj)].push_back(j);
-            projection1Map[get_neuron_index(resolution, xj, yj - 1)].push_back(j);
-            projection1Map[get_neuron_index(resolution, xj + 1, yj)].push_back(j);
-            projection1Map[get_neuron_index(resolution, xj, yj + 1)].push_back(j);
-
-            // Add diagonal neighbours to projection 2
-            projection2Map[get_neuron_index(resolution, xj - 1, yj - 1)].push_back(j);
-            projection2Map[get_neuron_index(resolution, xj + 1, yj - 1)].push_back(j);
-            projection2Map[get_neuron_index(resolution, xj + 1, yj + 1)].push_back(j);
-            projection2Map[get_neuron_index(resolution, xj - 1, yj + 1)].push_back(j);
-
-            // Add one away neighbours to projection 4
-            projection4Map[get_neuron_index(resolution, xj - 2, yj)].push_back(j);
-            projection4Map[get_neuron_index(resolution, xj, yj - 2)].push_back(j);
-            projection4Map[get_neuron_index(resolution, xj + 2, yj)].push_back(j);
-            projection4Map[get_neuron_index(resolution, xj, yj + 2)].push_back(j);
-        }
-    }
-
-    // Convert vector of vectors to GeNN format
-    unsigned int s1 = 0;
-    unsigned int s2 = 0;
-    unsigned int s4 = 0;
-    for(unsigned int i = 0; i < pop_size; i++)
-    {
-        projection1.indInG[i] = s1;
-        projection2.indInG[i] = s2;
-        projection4.indInG[i] = s4;
-
-        std::copy(projection1Map[i].cbegin(), projection1Map[i].cend(), &projection1.ind[s1]);
-        std::copy(projection2Map[i].cbegin(), projection2Map[i].cend(), &projection2.ind[s2]);
-        std::copy(projection4Map[i].cbegin(), projection4Map[i].cend(), &projection4.ind[s4]);
-
-        s1 += projection1Map[i].size();
-        s2 += projection2Map[i].size();
-        s4 += projection4Map[i].size();
-    }
-
-    // Add ending entries to data structure
-    projection1.indInG[pop_size] = s1;
-    projection2.indInG[pop_size] = s2;
-    projection4.indInG[pop_size] = s4;
-
-    // Check
-    assert(s1 == (centre_size * centre_size * 4));
-    assert(s2 == (centre_size * centre_size * 4));
-    assert(s4 == (centre_size * centre_size * 4));
-}
 }   // Anonymous namespace
 
 int main(int argc, char *argv[])
@@ -201,51 +68,74 @@ int main(int argc, char *argv[])
     allocateMem();
     initialize();
 
-    build_centre_to_one_connection(Parameters::input_size, Parameters::centre_size,
-                                   CP_F_LGMD, &allocateP_F_LGMD);
-    build_centre_to_one_connection(Parameters::input_size, Parameters::centre_size,
-                                   CS_LGMD, &allocateS_LGMD);
-    build_one_to_one_connection(Parameters::input_size,
-                                CP_E_S, &allocateP_E_S);
-    build_i_s_connections(Parameters::input_size, Parameters::centre_size,
-                          CP_I_S_1, &allocateP_I_S_1,
-                          CP_I_S_2, &allocateP_I_S_2,
+    buildCentreToOneConnector(Parameters::input_size, Parameters::input_size,
+                              Parameters::centre_size, Parameters::centre_size,
+                              CP_F_LGMD, &allocateP_F_LGMD);
+    buildCentreToOneConnector(Parameters::input_size, Parameters::input_size,
+                              Parameters::centre_size, Parameters::centre_size,
+                              CS_LGMD, &allocateS_LGMD);
+    buildOneToOneConnector(Parameters::input_size * Parameters::input_size,
+                           CP_E_S, &allocateP_E_S);
+
+    // Connect I neurons to S neurons in centre from adjacent, diagonal and one-away neighbours
+    // **NOTE** offsets are from presynaptic to postsynaptic neuron
+    const RetinotopicRect centre = getCentredRect(Parameters::input_size, Parameters::input_size,
+                                                  Parameters::centre_size, Parameters::centre_size);
+    buildStencilConnector(Parameters::input_size, Parameters::input_size, Parameters::input_size, centre, 1,
+                          {{-1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {1, 0, 0}},
+                          CP_I_S_1, &allocateP_I_S_1);
+    buildStencilConnector(Parameters::input_size, Parameters::input_size, Parameters::input_size, centre, 1,
+                          {{-1, -1, 0}, {-1, 1, 0}, {1, -1, 0}, {1, 1, 0}},
+                          CP_I_S_2, &allocateP_I_S_2);
+    buildStencilConnector(Parameters::input_size, Parameters::input_size, Parameters::input_size, centre, 1,
+                          {{-2, 0, 0}, {0, -2, 0}, {0, 2, 0}, {2, 0, 0}},
                           CP_I_S_4, &allocateP_I_S_4);
 
     initlgmd_opencv();
 
+    // Pace simulation in real time, by default dropping rendering until we catch up if we fall behind
+    // **NOTE** camera is read on a background thread and only the latest frame is used so input is never stale
+    const RealtimeLoop::OverrunPolicy overrunPolicy = (argc > 2) ? RealtimeLoop::parseOverrunPolicy(argv[2])
+        : RealtimeLoop::OverrunPolicy::DegradeRendering;
+    RealtimeLoop loop(Parameters::timestep, 1.0, overrunPolicy);
+
     // Loop through timesteps until there is no more import
-    double dvsUpdate = 0.0;
-    double dvsRender = 0.0;
-    double simulationStep = 0.0;
-    double download = 0.0;
-    double outputRender = 0.0;
-    double eventProcessing = 0.0;
+    Profiler profiler;
+    unsigned int nextRender = 0;
     for(unsigned int i = 0;; i++)
     {
+        const RealtimeLoop::Tick tick = loop.beginTick();
+        profiler.beginTick();
+
+        // Render at display rate rather than every timestep
+        const bool render = tick.render && i >= nextRender;
+        if(render) {
+            nextRender = i + Parameters::renderInterval;
+        }
+
         // Read DVS state and put result into GeNN
         {
-            ProfilingTimer t(dvsUpdate);
-            tie(inputCurrentsP, stepP) = dvs.update(i);
+            Profiler::Scope s(profiler, "DVS update");
+            tie(inputCurrentsP, stepP) = dvs.update();
         }
 
         // Show raw frame and difference with previous
-        {
-            ProfilingTimer t(dvsRender);
-            dvs.showDownsampledFrame("Downsampled frame", i);
+        if(render) {
+            Profiler::Scope s(profiler, "DVS render");
+            dvs.showDownsampledFrame("Downsampled frame");
             dvs.showFrameDifference("Frame difference");
         }
         
         // Simulate
 #ifndef CPU_ONLY
         {
-            ProfilingTimer t(simulationStep);
+            Profiler::Scope s(profiler, "Simulation step");
             stepTimeGPU();
         }
 
         //pullLGMDStateFromDevice();
         {
-            ProfilingTimer t(download);
+            Profiler::Scope s(profiler, "Download");
             
             pullPStateFromDevice();
             pullSStateFromDevice();
@@ -253,40 +143,43 @@ int main(int argc, char *argv[])
         }
 #else
         {
-            ProfilingTimer t(simulationStep);
+            Profiler::Scope s(profiler, "Simulation step");
             stepTimeCPU();
         }
 #endif
         
-        {
-            ProfilingTimer t(outputRender);
+        if(render) {
+            Profiler::Scope s(profiler, "Output render");
             
             cv::Mat wrappedPVoltage(32, 32, CV_32FC1, VP);
             cv::imshow("P Membrane voltage", wrappedPVoltage);
             
             cv::Mat wrappedSVoltage(32, 32, CV_32FC1, VS);
             cv::imshow("S Membrane voltage", wrappedSVoltage);
-            
-            if(spikeCount_LGMD > 0) {
-                std::cout << "LGMD SPIKE" << std::endl;
-            }
+        }
+
+        if(spikeCount_LGMD > 0) {
+            std::cout << "LGMD SPIKE" << std::endl;
         }
         
         // **YUCK** required for OpenCV GUI to do anything
-        {
-            ProfilingTimer t(eventProcessing);
+        if(render) {
+            Profiler::Scope s(profiler, "Event processing");
             
             if(cv::waitKey(1) == 27) {
-                std::cout << "DVS update:" << dvsUpdate / (double)i << std::endl;
-                std::cout << "DVS render:" << dvsRender / (double)i  << std::endl;
-                std::cout << "Simulation step:" << simulationStep / (double)i  << std::endl;
-                std::cout << "Download:" << download / (double)i  << std::endl;
-                std::cout << "Output render:" << outputRender / (double)i  << std::endl;
-                std::cout << "Event processing:" << eventProcessing / (double)i  << std::endl;
                 break;
             }
         }
+
+        profiler.endTick();
+
+        // Wait for this timestep's deadline
+        loop.endTick();
     }
+
+    loop.printSummary();
+    profiler.printSummary();
+    profiler.writeJSON("profile.json");
     
     
 
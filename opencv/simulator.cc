@@ -16,10 +16,19 @@
 // Common example code
 #include "../common/analogue_csv_recorder.h"
 #include "../common/opencv_dvs.h"
+#include "../common/realtime_loop.h"
 
 #include "opencv_CODE/definitions.h"
 
-
+//----------------------------------------------------------------------------
+// Anonymous namespace
+//----------------------------------------------------------------------------
+namespace
+{
+// How often to render input and output images for display (timesteps)
+// **NOTE** cv::waitKey alone takes over a timestep so rendering every timestep would always overrun
+const unsigned int renderInterval = 33;
+}   // Anonymous namespace
 
 int main(int argc, char *argv[])
 {
@@ -43,14 +52,30 @@ int main(int argc, char *argv[])
     
     initopencv();
 
+    // Pace simulation in real time, by default dropping rendering until we catch up if we fall behind
+    const RealtimeLoop::OverrunPolicy overrunPolicy = (argc > 2) ? RealtimeLoop::parseOverrunPolicy(argv[2])
+        : RealtimeLoop::OverrunPolicy::DegradeRendering;
+    RealtimeLoop loop(DT, 1.0, overrunPolicy);
+
+    unsigned int nextRender = 0;
     for(unsigned int i = 0;; i++)
     {
+        const RealtimeLoop::Tick tick = loop.beginTick();
+
+        // Render at display rate rather than every timestep
+        const bool render = tick.render && i >= nextRender;
+        if(render) {
+            nextRender = i + renderInterval;
+        }
+
         // Read DVS state and put result into GeNN
-        tie(inputCurrentsP, stepP) = dvs.update(i);
+        tie(inputCurrentsP, stepP) = dvs.update();
 
         // Show raw frame and difference with previous
-        dvs.showDownsampledFrame("Downsampled frame", i);
-        dvs.showFrameDifference("Frame difference");
+        if(render) {
+            dvs.showDownsampledFrame("Downsampled frame");
+            dvs.showFrameDifference("Frame difference");
+        }
 
         // Simulate
 #ifndef CPU_ONLY
@@ -61,10 +86,15 @@ int main(int argc, char *argv[])
         stepTimeCPU();
 #endif
         
-        cv::Mat wrappedVoltage(32, 32, CV_32FC1, VP);
-        cv::imshow("P Membrane voltage", wrappedVoltage);
-        // **YUCK** required for OpenCV GUI to do anything
-        cv::waitKey(1);
+        if(render) {
+            cv::Mat wrappedVoltage(32, 32, CV_32FC1, VP);
+            cv::imshow("P Membrane voltage", wrappedVoltage);
+            // **YUCK** required for OpenCV GUI to do anything
+            cv::waitKey(1);
+        }
+
+        // Wait for this timestep's deadline
+        loop.endTick();
     }
 
 
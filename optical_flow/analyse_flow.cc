@@ -0,0 +1,93 @@
+// Standard C++ includes
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Standard C includes
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Summarises flow fields recorded by optical_flow in headless mode. For each
+// file, prints the number of records, the mean magnitude of the per-detector
+// flow vectors and the magnitude and direction of the mean flow vector.
+// **NOTE** directions are in degrees with y pointing down, as displayed
+
+//----------------------------------------------------------------------------
+// Anonymous namespace
+//----------------------------------------------------------------------------
+namespace
+{
+bool analyseFlow(const char *filename)
+{
+    std::ifstream stream(filename, std::ios::binary);
+    if(!stream.good()) {
+        std::cerr << "Cannot open '" << filename << "'" << std::endl;
+        return false;
+    }
+
+    // Read and check header written by AnalogueBinaryRecorder<float> in raw mode
+    char magic[8];
+    uint32_t header[4];
+    if(!stream.read(magic, 8) || memcmp(magic, "GENNANA1", 8) != 0
+        || !stream.read(reinterpret_cast<char*>(header), sizeof(header))
+        || header[1] != sizeof(float) || header[3] != 0 || (header[0] % 2) != 0)
+    {
+        std::cerr << "'" << filename << "' is not a raw float flow field recording" << std::endl;
+        return false;
+    }
+
+    // Skip neuron IDs
+    const uint32_t numValues = header[0];
+    stream.seekg(sizeof(uint32_t) * numValues, std::ios::cur);
+
+    // Loop through records
+    std::vector<float> values(numValues);
+    double time;
+    double sumMagnitude = 0.0;
+    double sumX = 0.0;
+    double sumY = 0.0;
+    uint64_t numRecords = 0;
+    while(stream.read(reinterpret_cast<char*>(&time), sizeof(double))
+          && stream.read(reinterpret_cast<char*>(values.data()), sizeof(float) * numValues))
+    {
+        // Each detector has an x and y component
+        for(uint32_t d = 0; d < numValues; d += 2) {
+            const double x = values[d];
+            const double y = values[d + 1];
+            sumMagnitude += std::sqrt((x * x) + (y * y));
+            sumX += x;
+            sumY += y;
+        }
+        numRecords++;
+    }
+
+    const double numVectors = (double)numRecords * (double)(numValues / 2);
+    const double meanMagnitude = (numRecords == 0) ? 0.0 : (sumMagnitude / numVectors);
+    const double meanX = (numRecords == 0) ? 0.0 : (sumX / numVectors);
+    const double meanY = (numRecords == 0) ? 0.0 : (sumY / numVectors);
+    const double meanDirection = std::atan2(meanY, meanX) * 180.0 / M_PI;
+
+    std::cout << filename << "," << numRecords << "," << meanMagnitude << ","
+        << std::sqrt((meanX * meanX) + (meanY * meanY)) << "," << meanDirection << std::endl;
+    return true;
+}
+}   // Anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2) {
+        std::cerr << "Usage: analyse_flow FLOW_FILE..." << std::endl;
+        return 1;
+    }
+
+    std::cout << "File,Records,Mean magnitude,Mean flow magnitude,Mean flow direction [degrees]" << std::endl;
+
+    bool success = true;
+    for(int a = 1; a < argc; a++) {
+        success &= analyseFlow(argv[a]);
+    }
+
+    return success ? 0 : 1;
+}
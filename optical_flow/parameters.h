@@ -30,5 +30,26 @@ namespace Parameters
 
     const float spikePersistence = 0.995f;
 
+    // How often to render input image for display (timesteps)
+    const unsigned int inputRenderInterval = 33;
+
     const float outputVectorScale = 2.0f;
+
+    // Multiple of real time to replay pre-recorded events at (0 runs as fast as possible)
+    const double replaySpeed = 1.0;
+
+    // How long before each timestep's deadline to stop sleeping and busy-wait (us)
+    const double busyWaitUs = 200.0;
+
+    // How often to write the flow field to disk in headless mode (timesteps)
+    const unsigned int flowRecordInterval = 10;
+
+    // How many timesteps of DVS events to read ahead of the simulation when replaying
+    // recordings and, as this bounds how far behind the sensor we can fall, from live devices
+    const unsigned int prefetchBatches = 1024;
+    const unsigned int livePrefetchBatches = 8;
+
+    // Typical number of DVS events per timestep, used to size the prefetch buffer
+    // **NOTE** bursts larger than this can borrow space left by quieter timesteps
+    const unsigned int prefetchEventsPerBatch = 256;
 }
\ No newline at end of file
@@ -3,10 +3,10 @@
 #include <fstream>
 #include <iostream>
 #include <limits>
-#include <mutex>
 #include <random>
 #include <set>
 #include <sstream>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -19,13 +19,23 @@
 #include <opencv2/highgui/highgui.hpp>
 
 // Common example includes
+#include "../common/analogue_binary_recorder.h"
+#include "../common/flow_field.h"
+#include "../common/prefetching_event_source.h"
+#include "../common/profiler.h"
+#include "../common/realtime_loop.h"
+#include "../common/retinotopic_connectors.h"
 #include "../common/spike_image_renderer.h"
-#include "../common/timer.h"
+#include "../common/triple_buffer.h"
 
 #ifdef DVS
     #include "../common/dvs_128.h"
 #elif CSV
     #include "../common/dvs_pre_recorded.h"
+#elif BINARY
+    #include "../common/dvs_pre_recorded_binary.h"
+#elif SYNTHETIC
+    #include "../common/dvs_synthetic.h"
 #else
     #include "../common/dvs_pre_recorded_ms.h"
 #endif
@@ -42,8 +52,6 @@
 //----------------------------------------------------------------------------
 namespace
 {
-typedef void (*allocateFn)(unsigned int);
-
 volatile std::sig_atomic_t g_SignalStatus;
 
 void signalHandler(int status)
@@ -52,11 +60,6 @@ void signalHandler(int status)
 }
 
 
-unsigned int getNeuronIndex(unsigned int resolution, unsigned int x, unsigned int y)
-{
-    return x + (y * resolution);
-}
-
 void print_sparse_matrix(unsigned int pre_resolution, const SparseProjection &projection)
 {
     const unsigned int pre_size = pre_resolution * pre_resolution;
@@ -73,135 +76,7 @@ void print_sparse_matrix(unsigned int pre_resolution, const SparseProjection &pr
     }
 }
 
-void buildCentreToMacroConnection(SparseProjection &projection, allocateFn allocate)
-{
-    // Allocate centre_size * centre_size connections
-    allocate(Parameters::centreSize * Parameters::centreSize);
-
-    // Calculate start and end of border on each row
-    const unsigned int near_border = (Parameters::inputSize - Parameters::centreSize) / 2;
-    const unsigned int far_border = near_border + Parameters::centreSize;
-
-    // Loop through rows of pixels in centre
-    unsigned int s = 0;
-    unsigned int i = 0;
-    for(unsigned int yi = 0; yi < Parameters::inputSize; yi++)
-    {
-        for(unsigned int xi = 0; xi < Parameters::inputSize; xi++)
-        {
-            projection.indInG[i++] = s;
-
-            // If we're in the centre
-            if(xi >= near_border && xi < far_border && yi >= near_border && yi < far_border) {
-                const unsigned int yj = (yi - near_border) / Parameters::kernelSize;
-                const unsigned int xj = (xi - near_border) / Parameters::kernelSize;
-                projection.ind[s++] = getNeuronIndex(Parameters::macroPixelSize, xj, yj);
-            }
-        }
-    }
-
-    // Add ending entry to data structure
-    projection.indInG[i] = s;
-
-    // Check
-    assert(s == (Parameters::centreSize * Parameters::centreSize));
-    assert(i == (Parameters::inputSize * Parameters::inputSize));
-}
-
-void buildDetectors(SparseProjection &excitatoryProjection, SparseProjection &inhibitoryProjection,
-                    allocateFn allocateExcitatory, allocateFn allocateInhibitory)
-{
-    allocateExcitatory(Parameters::detectorSize * Parameters::detectorSize * Parameters::DetectorMax);
-    allocateInhibitory(Parameters::detectorSize * Parameters::detectorSize * Parameters::DetectorMax);
-
-    // Loop through macro cells
-    unsigned int sExcitatory = 0;
-    unsigned int iExcitatory = 0;
-    unsigned int sInhibitory = 0;
-    unsigned int iInhibitory = 0;
-    for(unsigned int yi = 0; yi < Parameters::macroPixelSize; yi++)
-    {
-        for(unsigned int xi = 0; xi < Parameters::macroPixelSize; xi++)
-        {
-            // Mark start of 'synaptic row'
-            excitatoryProjection.indInG[iExcitatory++] = sExcitatory;
-            inhibitoryProjection.indInG[iInhibitory++] = sInhibitory;
-
-            // If we're not in border region
-            if(xi >= 1 && xi < (Parameters::macroPixelSize - 1)
-                && yi >= 1 && yi < (Parameters::macroPixelSize - 1))
-            {
-                const unsigned int xj = (xi - 1) * Parameters::DetectorMax;
-                const unsigned int yj = yi - 1;
-
-                // Add excitatory synapses to all detectors
-                excitatoryProjection.ind[sExcitatory++] = getNeuronIndex(Parameters::detectorSize * Parameters::DetectorMax,
-                                                                         xj + Parameters::DetectorLeft, yj);
-                excitatoryProjection.ind[sExcitatory++] = getNeuronIndex(Parameters::detectorSize * Parameters::DetectorMax,
-                                                                         xj + Parameters::DetectorRight, yj);
-                excitatoryProjection.ind[sExcitatory++] = getNeuronIndex(Parameters::detectorSize * Parameters::DetectorMax,
-                                                                         xj + Parameters::DetectorUp, yj);
-                excitatoryProjection.ind[sExcitatory++] = getNeuronIndex(Parameters::detectorSize * Parameters::DetectorMax,
-                                                                         xj + Parameters::DetectorDown, yj);
-            }
-
-
-            // Create inhibitory connection to 'left' detector associated with macropixel one to right
-            if(xi < (Parameters::macroPixelSize - 2)
-                && yi >= 1 && yi < (Parameters::macroPixelSize - 1))
-            {
-                const unsigned int xj = (xi - 1 + 1) * Parameters::DetectorMax;
-                const unsigned int yj = yi - 1;
-                inhibitoryProjection.ind[sInhibitory++] = getNeuronIndex(Parameters::detectorSize * Parameters::DetectorMax,
-                                                                         xj + Parameters::DetectorLeft, yj);
-            }
-
-            // Create inhibitory connection to 'right' detector associated with macropixel one to right
-            if(xi >= 2
-                && yi >= 1 && yi < (Parameters::macroPixelSize - 1))
-            {
-                const unsigned int xj = (xi - 1 - 1) * Parameters::DetectorMax;
-                const unsigned int yj = yi - 1;
-                inhibitoryProjection.ind[sInhibitory++] = getNeuronIndex(Parameters::detectorSize * Parameters::DetectorMax,
-                                                                         xj + Parameters::DetectorRight, yj);
-            }
-
-            // Create inhibitory connection to 'up' detector associated with macropixel one below
-            if(xi >= 1 && xi < (Parameters::macroPixelSize - 1)
-                && yi < (Parameters::macroPixelSize - 2))
-            {
-                const unsigned int xj = (xi - 1) * Parameters::DetectorMax;
-                const unsigned int yj = yi - 1 + 1;
-                inhibitoryProjection.ind[sInhibitory++] = getNeuronIndex(Parameters::detectorSize * Parameters::DetectorMax,
-                                                                         xj + Parameters::DetectorUp, yj);
-            }
-
-            // Create inhibitory connection to 'down' detector associated with macropixel one above
-            if(xi >= 1 && xi < (Parameters::macroPixelSize - 1)
-                && yi >= 2)
-            {
-                const unsigned int xj = (xi - 1) * Parameters::DetectorMax;
-                const unsigned int yj = yi - 1 - 1;
-                inhibitoryProjection.ind[sInhibitory++] = getNeuronIndex(Parameters::detectorSize * Parameters::DetectorMax,
-                                                                         xj + Parameters::DetectorDown, yj);
-            }
-
-        }
-    }
-
-    // Add ending entry to data structure
-    excitatoryProjection.indInG[iExcitatory] = sExcitatory;
-    inhibitoryProjection.indInG[iInhibitory] = sInhibitory;
-
-    // Check
-    assert(sExcitatory == (Parameters::detectorSize * Parameters::detectorSize * Parameters::DetectorMax));
-    assert(iExcitatory == (Parameters::macroPixelSize * Parameters::macroPixelSize));
-    assert(sInhibitory == (Parameters::detectorSize * Parameters::detectorSize * Parameters::DetectorMax));
-    assert(iInhibitory == (Parameters::macroPixelSize * Parameters::macroPixelSize));
-}
-
-void displayThreadHandler(std::mutex &inputMutex, const cv::Mat &inputImage,
-                          std::mutex &outputMutex, const float (&output)[Parameters::detectorSize][Parameters::detectorSize][2])
+void displayThreadHandler(TripleBuffer<cv::Mat> &inputBuffer, TripleBuffer<std::vector<float>> &outputBuffer)
 {
     cv::namedWindow("Input", CV_WINDOW_NORMAL);
     cv::resizeWindow("Input", Parameters::inputSize * Parameters::inputScale,
@@ -223,16 +98,19 @@ void displayThreadHandler(std::mutex &inputMutex, const cv::Mat &inputImage,
         outputImage.setTo(cv::Scalar::all(0));
 
         {
-            std::lock_guard<std::mutex> lock(outputMutex);
+            // Get latest output snapshot
+            outputBuffer.update();
+            const std::vector<float> &output = outputBuffer.getReadBuffer();
 
             // Loop through output coordinates
             for(unsigned int x = 0; x < Parameters::detectorSize; x++)
             {
                 for(unsigned int y = 0; y < Parameters::detectorSize; y++)
                 {
+                    const float *vector = &output[((x * Parameters::detectorSize) + y) * 2];
                     const cv::Point start(x * Parameters::outputScale, y * Parameters::outputScale);
-                    const cv::Point end = start + cv::Point(Parameters::outputVectorScale * output[x][y][0],
-                                                            Parameters::outputVectorScale * output[x][y][1]);
+                    const cv::Point end = start + cv::Point(Parameters::outputVectorScale * vector[0],
+                                                            Parameters::outputVectorScale * vector[1]);
 
                     cv::line(outputImage, start, end,
                              CV_RGB(0xFF, 0xFF, 0xFF));
@@ -264,60 +142,14 @@ void displayThreadHandler(std::mutex &inputMutex, const cv::Mat &inputImage,
 
         cv::imshow("Output", outputImage);
 
-        {
-            std::lock_guard<std::mutex> lock(inputMutex);
-            cv::imshow("Input", inputImage);
-        }
+        // Show latest input snapshot
+        inputBuffer.update();
+        cv::imshow("Input", inputBuffer.getReadBuffer());
 
 
         cv::waitKey(33);
     }
 }
-
-void applyOutputSpikes(unsigned int outputSpikeCount, const unsigned int *outputSpikes, float (&output)[Parameters::detectorSize][Parameters::detectorSize][2])
-{
-    // Loop through output spikes
-    for(unsigned int s = 0; s < outputSpikeCount; s++)
-    {
-        // Convert spike ID to x, y, detector
-        const unsigned int spike = outputSpikes[s];
-        const auto spikeCoord = std::div((int)spike, (int)Parameters::detectorSize * Parameters::DetectorMax);
-        const int spikeY = spikeCoord.quot;
-        const auto xCoord = std::div(spikeCoord.rem, (int)Parameters::DetectorMax);
-        const int spikeX =  xCoord.quot;
-
-        // Apply spike to correct axis of output pixel based on detector it was emitted by
-        switch(xCoord.rem)
-        {
-            case Parameters::DetectorLeft:
-                output[spikeX][spikeY][0] -= 1.0f;
-                break;
-
-            case Parameters::DetectorRight:
-                output[spikeX][spikeY][0] += 1.0f;
-                break;
-
-            case Parameters::DetectorUp:
-                output[spikeX][spikeY][1] -= 1.0f;
-                break;
-
-            case Parameters::DetectorDown:
-                output[spikeX][spikeY][1] += 1.0f;
-                break;
-
-        }
-    }
-
-    // Decay output
-    for(unsigned int x = 0; x < Parameters::detectorSize; x++)
-    {
-        for(unsigned int y = 0; y < Parameters::detectorSize; y++)
-        {
-            output[x][y][0] *= Parameters::spikePersistence;
-            output[x][y][1] *= Parameters::spikePersistence;
-        }
-    }
-}
 }
 
 int main(int argc, char *argv[])
@@ -325,54 +157,133 @@ int main(int argc, char *argv[])
     allocateMem();
     initialize();
 
-    buildCentreToMacroConnection(CDVS_MacroPixel, &allocateDVS_MacroPixel);
-    buildDetectors(CMacroPixel_Output_Excitatory, CMacroPixel_Output_Inhibitory,
-                   &allocateMacroPixel_Output_Excitatory, &allocateMacroPixel_Output_Inhibitory);
+    // Pool kernelSize * kernelSize blocks of pixels from centre of DVS into macro pixels
+    buildPoolingConnector(Parameters::inputSize, Parameters::inputSize,
+                          Parameters::centreSize, Parameters::centreSize,
+                          Parameters::kernelSize, Parameters::kernelSize,
+                          CDVS_MacroPixel, &allocateDVS_MacroPixel);
+
+    // Detector cells are associated with the macro pixels inside the one pixel border
+    // **NOTE** offsets are from presynaptic macro pixel to postsynaptic detector cell
+    const RetinotopicRect detectors{0, 0, Parameters::detectorSize, Parameters::detectorSize};
+
+    // Each macro pixel excites all detectors associated with it
+    buildStencilConnector(Parameters::macroPixelSize, Parameters::macroPixelSize, Parameters::detectorSize,
+                          detectors, Parameters::DetectorMax,
+                          {{-1, -1, Parameters::DetectorLeft}, {-1, -1, Parameters::DetectorRight},
+                           {-1, -1, Parameters::DetectorUp}, {-1, -1, Parameters::DetectorDown}},
+                          CMacroPixel_Output_Excitatory, &allocateMacroPixel_Output_Excitatory);
+
+    // Each macro pixel inhibits the left detector associated with the macro pixel to its right,
+    // the right detector to its left, the up detector below and the down detector above
+    buildStencilConnector(Parameters::macroPixelSize, Parameters::macroPixelSize, Parameters::detectorSize,
+                          detectors, Parameters::DetectorMax,
+                          {{0, -1, Parameters::DetectorLeft}, {-2, -1, Parameters::DetectorRight},
+                           {-1, 0, Parameters::DetectorUp}, {-1, -2, Parameters::DetectorDown}},
+                          CMacroPixel_Output_Inhibitory, &allocateMacroPixel_Output_Inhibitory);
     //print_sparse_matrix(Parameters::inputSize, CDVS_MacroPixel);
     initoptical_flow();
 
 #ifdef DVS
      // Create DVS 128 device
-    DVS128 dvs(DVS128::Polarity::On);
-#elif CSV
+    DVS128 dvsSource(DVS128::Polarity::On);
+
+    // Read events from device every timestep on prefetch thread
+    PrefetchingEventSource<DVS128> dvs(dvsSource, Parameters::livePrefetchBatches, Parameters::prefetchEventsPerBatch,
+                                       std::chrono::duration<double, std::milli>{DT});
+#else
+#ifdef CSV
     assert(argc > 1);
-    DVSPreRecorded dvs(argv[1], DVSPreRecorded::Polarity::On, DT, true);
+    DVSPreRecorded dvsSource(argv[1], DVSPreRecorded::Polarity::On, DT, true);
+#elif BINARY
+    // **NOTE** any flipping is applied when converting to binary
+    assert(argc > 1);
+    DVSPreRecordedBinary dvsSource(argv[1], DVSPreRecordedBinary::Polarity::On, DT);
+#elif SYNTHETIC
+    // **NOTE** first argument specifies scene rather than file
+    assert(argc > 1);
+    DVSSynthetic dvsSource(DVSSynthetic::parseScene(argv[1]), DVSSynthetic::Polarity::On, DT);
 #else
     assert(argc > 1);
-    DVSPreRecordedMs dvs(argv[1]);
+    DVSPreRecordedMs dvsSource(argv[1]);
 #endif
 
-    double dvsGet = 0.0;
-    double step = 0.0;
-    double render = 0.0;
+    // If specified, replay only a window of the recording: simulator FILE [START_MS] [END_MS]
+    if(argc > 2) {
+        dvsSource.seek(std::stod(argv[2]));
+    }
+    if(argc > 3) {
+        dvsSource.setEndTime(std::stod(argv[3]));
+    }
 
+    // Read events from file ahead of time on prefetch thread
+    PrefetchingEventSource<decltype(dvsSource)> dvs(dvsSource, Parameters::prefetchBatches, Parameters::prefetchEventsPerBatch);
+#endif
+    dvs.start();
 
-    std::mutex inputMutex;
-    cv::Mat inputImage(Parameters::inputSize, Parameters::inputSize, CV_32F);
+    // Flow field accumulated from output spikes
+    // **NOTE** detectors are listed in the order of Parameters::Detector
+    static_assert(Parameters::DetectorLeft == 0 && Parameters::DetectorRight == 1
+                  && Parameters::DetectorUp == 2 && Parameters::DetectorDown == 3, "Unexpected detector order");
+    FlowField output(Parameters::detectorSize, Parameters::detectorSize, Parameters::spikePersistence,
+                     {{0, -1.0f}, {0, 1.0f}, {1, -1.0f}, {1, 1.0f}});
 
-    std::mutex outputMutex;
-    float output[Parameters::detectorSize][Parameters::detectorSize][2] = {0};
-    std::thread displayThread(displayThreadHandler,
-                              std::ref(inputMutex), std::ref(inputImage),
-                              std::ref(outputMutex), std::ref(output));
+#ifdef HEADLESS
+    // Record decayed flow field every flowRecordInterval timesteps
+#ifdef DVS
+    const std::string flowFilename = "flow.bin";
+#else
+    const std::string flowFilename = std::string(argv[1]) + ".flow.bin";
+#endif
+    AnalogueBinaryRecorder<float> flowRecorder(flowFilename.c_str(), output.getData(),
+                                               Parameters::detectorSize * Parameters::detectorSize * 2,
+                                               Parameters::flowRecordInterval);
+#else
+    // Decaying image of input spikes
+    LazySpikeImageRenderer inputRenderer(Parameters::inputSize, Parameters::inputSize, Parameters::spikePersistence);
 
-    // Convert timestep to a duration
-    const auto dtDuration = std::chrono::duration<double, std::milli>{DT};
+    // Snapshots of input and output are handed to display thread without the simulation ever waiting
+    TripleBuffer<cv::Mat> inputBuffer(Parameters::inputSize, Parameters::inputSize, CV_32F);
+    TripleBuffer<std::vector<float>> outputBuffer(output.getVectors().size(), 0.0f);
+    std::thread displayThread(displayThreadHandler, std::ref(inputBuffer), std::ref(outputBuffer));
+#endif
+
+#ifdef DVS
+    // Live devices can only run in real time and, if we fall behind, stale events are worthless
+    const double replaySpeed = 1.0;
+    const RealtimeLoop::OverrunPolicy overrunPolicy = RealtimeLoop::OverrunPolicy::SkipInput;
+#else
+    // Replay speed multiplier: simulator FILE [START_MS] [END_MS] [SPEED] [POLICY] where 0 runs as fast as possible
+    const double replaySpeed = (argc > 4) ? std::stod(argv[4]) : Parameters::replaySpeed;
+    const RealtimeLoop::OverrunPolicy overrunPolicy = (argc > 5) ? RealtimeLoop::parseOverrunPolicy(argv[5])
+        : RealtimeLoop::OverrunPolicy::CatchUp;
+#endif
+
+    // Pace simulation against wall-clock time
+    RealtimeLoop loop(DT, replaySpeed, overrunPolicy, Parameters::busyWaitUs);
 
-    // Duration counters
-    std::chrono::duration<double, std::milli> sleepTime{0};
-    std::chrono::duration<double, std::milli> overrunTime{0};
+    // Record per-timestep latency of each stage so overruns of the real-time budget can be attributed
+    Profiler profiler;
     unsigned int i = 0;
+#ifndef HEADLESS
+    unsigned int nextInputRender = 0;
+#endif
 
      // Catch interrupt (ctrl-c) signals
     std::signal(SIGINT, signalHandler);
 
-    for(i = 0; g_SignalStatus == 0; i++)
+    for(i = 0; g_SignalStatus == 0 && !dvs.isFinished(); i++)
     {
-        auto tickStart = std::chrono::high_resolution_clock::now();
+        const RealtimeLoop::Tick tick = loop.beginTick();
+        profiler.beginTick();
 
         {
-            TimerAccumulate<std::milli> timer(dvsGet);
+            Profiler::Scope s(profiler, "DVS get");
+
+            // Discard events from any timesteps the loop has given up on
+            for(unsigned int k = 0; k < tick.inputToSkip; k++) {
+                dvs.readEvents(spikeCount_DVS, spike_DVS);
+            }
             dvs.readEvents(spikeCount_DVS, spike_DVS);
 
 #ifndef CPU_ONLY
@@ -381,17 +292,22 @@ int main(int argc, char *argv[])
 #endif
         }
 
+#ifndef HEADLESS
         {
-            TimerAccumulate<std::milli> timer(render);
-            {
-                std::lock_guard<std::mutex> lock(inputMutex);
-                renderSpikeImage(spikeCount_DVS, spike_DVS, Parameters::inputSize,
-                                 Parameters::spikePersistence, inputImage);
+            Profiler::Scope s(profiler, "Input render");
+            inputRenderer.addSpikes(spikeCount_DVS, spike_DVS);
+
+            // Periodically render input image and publish it to display thread
+            if(tick.render && i >= nextInputRender) {
+                inputRenderer.render(inputBuffer.getWriteBuffer());
+                inputBuffer.publish();
+                nextInputRender = i + Parameters::inputRenderInterval;
             }
         }
+#endif
 
         {
-            TimerAccumulate<std::milli> timer(step);
+            Profiler::Scope s(profiler, "Simulation step");
 
             // Simulate
 #ifndef CPU_ONLY
@@ -403,36 +319,55 @@ int main(int argc, char *argv[])
         }
 
         {
-            TimerAccumulate<std::milli> timer(render);
-            {
-                std::lock_guard<std::mutex> lock(outputMutex);
-                applyOutputSpikes(spikeCount_Output, spike_Output, output);
+            Profiler::Scope s(profiler, "Output render");
+            output.apply(spikeCount_Output, spike_Output);
+
+#ifndef HEADLESS
+            // Publish copy of output to display thread
+            if(tick.render) {
+                std::copy(output.getVectors().cbegin(), output.getVectors().cend(), outputBuffer.getWriteBuffer().begin());
+                outputBuffer.publish();
             }
+#endif
         }
 
-        // Get time of tick start
-        auto tickEnd = std::chrono::high_resolution_clock::now();
-
-        // If there we're ahead of real-time pause
-        auto tickDuration = tickEnd - tickStart;
-        if(tickDuration < dtDuration) {
-            auto tickSleep = dtDuration - tickDuration;
-            sleepTime += tickSleep;
-            std::this_thread::sleep_for(tickSleep);
-        }
-        else {
-            overrunTime += (tickDuration - dtDuration);
+#ifdef HEADLESS
+        {
+            Profiler::Scope s(profiler, "Record flow");
+            flowRecorder.record((double)i * DT);
         }
+#endif
+
+        // Wait for this timestep's deadline
+        // **NOTE** tick is profiled before waiting so it measures the work against the DT budget
+        profiler.endTick();
+        loop.endTick();
     }
 
+    // If we reached the end of the recording, tell display thread to stop too
+    if(g_SignalStatus == 0) {
+        g_SignalStatus = SIGINT;
+    }
+
+#ifndef HEADLESS
     // Wait for display thread to die
     displayThread.join();
+#endif
 
     // Stop DVS
     dvs.stop();
 
-    std::cout << "Ran for " << i << " " << DT << "ms timesteps, overan for " << overrunTime.count() << "ms, slept for " << sleepTime.count() << "ms" << std::endl;
-    std::cout << "DVS:" << dvsGet << "ms, Step:" << step << "ms, Render:" << render << std::endl;
+    loop.printSummary();
+    std::cout << "Achieved " << ((double)i * DT) / loop.getElapsedMs() << "x real time (requested " << replaySpeed << "x)" << std::endl;
+    profiler.printSummary();
+    profiler.writeJSON("profile.json");
+    std::cout << "Event prefetch ran dry for " << dvs.getNumDryTicks() << "/" << dvs.getNumTicks() << " ticks, minimum occupancy " << dvs.getMinOccupancy() << "/" << dvs.getNumBatches() << " batches" << std::endl;
+#ifdef DVS
+    // **NOTE** when replaying, the ring is expected to be full
+    if(dvs.getNumFullWaits() > 0) {
+        std::cout << "WARNING: event prefetch was full for " << dvs.getNumFullWaits() << " batches - simulation fell behind DVS" << std::endl;
+    }
+#endif
 
     return 0;
 }
\ No newline at end of file
@@ -30,4 +30,8 @@ namespace Parameters
     const double excitatoryWeight = 4.0E-3 * scale;
     const double inhibitoryWeight = -51.0E-3 * scale;
 
+    // Seed used to build connectivity and randomise initial state
+    // **NOTE** fixed so runs are reproducible and all MPI hosts build the same connectivity
+    const unsigned int seed = 1234;
+
 }
\ No newline at end of file
@@ -1,42 +1,49 @@
-import csv
 import matplotlib.pyplot as plt
 import numpy as np
 
-with open("spikes.csv", "rb") as spikes_csv_file:
-    spikes_csv_reader = csv.reader(spikes_csv_file, delimiter = ",")
+def read_spikes(filename):
+    # Read spikes written by SpikeBinaryRecorder: 8 byte magic followed, for each timestep
+    # with spikes, by a double time, a uint32 spike count and that many uint32 neuron IDs
+    with open(filename, "rb") as spikes_file:
+        data = spikes_file.read()
+    assert data[:8] == b"GENNSPK1", "%s is not a binary spike file" % filename
 
-    # Skip headers
-    spikes_csv_reader.next()
+    times = [np.empty(0)]
+    ids = [np.empty(0, dtype=np.uint32)]
+    offset = 8
+    while (offset + 12) <= len(data):
+        time = np.frombuffer(data, dtype="<f8", count=1, offset=offset)[0]
+        count = np.frombuffer(data, dtype="<u4", count=1, offset=offset + 8)[0]
+        ids.append(np.frombuffer(data, dtype="<u4", count=count, offset=offset + 12))
+        times.append(np.repeat(time, count))
+        offset += 12 + (4 * count)
 
-    # Read data and zip into columns
-    spikes_data_columns = zip(*spikes_csv_reader)
+    return np.concatenate(times), np.concatenate(ids).astype(int)
 
-    # Convert CSV columns to numpy
-    spike_times = np.asarray(spikes_data_columns[0], dtype=float)
-    spike_neuron_id = np.asarray(spikes_data_columns[1], dtype=int)
+spike_times, spike_neuron_id = read_spikes("spikes.bin")
 
-    # Create plot
-    figure, axes = plt.subplots(2, sharex=True)
+# Create plot
+figure, axes = plt.subplots(2, sharex=True)
 
-    # Plot spikes
-    axes[0].scatter(spike_times, spike_neuron_id, s=2, edgecolors="none")
+# Plot spikes
+axes[0].scatter(spike_times, spike_neuron_id, s=2, edgecolors="none")
 
-    # Plot rates
-    bins = np.arange(0, 10000 + 1, 10)
-    rate = np.histogram(spike_times, bins=bins)[0] *  (1000.0 / 10.0) * (1.0 / 3200.0)
-    axes[1].plot(bins[0:-1], rate)
+# Plot rates
+bins = np.arange(0, 10000 + 1, 10)
+rate = np.histogram(spike_times, bins=bins)[0] *  (1000.0 / 10.0) * (1.0 / 3200.0)
+axes[1].plot(bins[0:-1], rate)
 
-    axes[0].set_title("Spikes")
-    axes[1].set_title("Firing rates")
+axes[0].set_title("Spikes")
+axes[1].set_title("Firing rates")
 
-    axes[0].set_xlim((0, 10000))
-    axes[0].set_ylim((0, 3200))
+axes[0].set_xlim((0, 10000))
+axes[0].set_ylim((0, 3200))
 
-    axes[0].set_ylabel("Neuron number")
-    axes[1].set_ylabel("Mean firing rate [Hz]")
+axes[0].set_ylabel("Neuron number")
+axes[1].set_ylabel("Mean firing rate [Hz]")
 
-    axes[1].set_xlabel("Time [ms]")
+axes[1].set_xlabel("Time [ms]")
 
-    # Show plot
-    plt.show()
+# Show plot
+plt.show()
 
@@ -3,8 +3,8 @@
 #include <numeric>
 #include <random>
 
-#include "../common/connectors.h"
-#include "../common/spike_csv_recorder.h"
+#include "../common/connectivity_cache.h"
+#include "../common/spike_binary_recorder.h"
 
 #include "parameters.h"
 
@@ -20,22 +20,21 @@ int main()
   auto  initStart = chrono::steady_clock::now(); 
   initialize();
 
-  std::random_device rd;
-  std::mt19937 gen(rd());
-
-  buildFixedProbabilityConnector(Parameters::numInhibitory, Parameters::numInhibitory, Parameters::probabilityConnection,
-                                 CII, &allocateII, gen);
-  buildFixedProbabilityConnector(Parameters::numInhibitory, Parameters::numExcitatory, Parameters::probabilityConnection,
-                                 CIE, &allocateIE, gen);
-  buildFixedProbabilityConnector(Parameters::numExcitatory, Parameters::numExcitatory, Parameters::probabilityConnection,
-                                 CEE, &allocateEE, gen);
-  buildFixedProbabilityConnector(Parameters::numExcitatory, Parameters::numInhibitory, Parameters::probabilityConnection,
-                                 CEI, &allocateEI, gen);
+  // Build connectivity using a different seed for each projection
+  buildFixedProbabilityConnectorCached(Parameters::numInhibitory, Parameters::numInhibitory, Parameters::probabilityConnection,
+                                       CII, &allocateII, Parameters::seed);
+  buildFixedProbabilityConnectorCached(Parameters::numInhibitory, Parameters::numExcitatory, Parameters::probabilityConnection,
+                                       CIE, &allocateIE, Parameters::seed + 1);
+  buildFixedProbabilityConnectorCached(Parameters::numExcitatory, Parameters::numExcitatory, Parameters::probabilityConnection,
+                                       CEE, &allocateEE, Parameters::seed + 2);
+  buildFixedProbabilityConnectorCached(Parameters::numExcitatory, Parameters::numInhibitory, Parameters::probabilityConnection,
+                                       CEI, &allocateEI, Parameters::seed + 3);
 
   // Final setup
   initva_benchmark();
 
-  // Randomlise initial membrane voltages
+  // Randomlise initial membrane voltages using a seed distinct from those used for connectivity
+  std::mt19937 gen(Parameters::seed + 4);
   std::uniform_real_distribution<> dis(Parameters::resetVoltage, Parameters::thresholdVoltage);
   for(unsigned int i = 0; i < Parameters::numExcitatory; i++)
   {
@@ -50,8 +49,9 @@ int main()
   auto  initEnd = chrono::steady_clock::now();
   printf("Init %ldms\n", chrono::duration_cast<chrono::milliseconds>(initEnd - initStart).count());
 
-  // Open CSV output files
-  SpikeCSVRecorder spikes("spikes.csv", glbSpkCntE, glbSpkE);
+  // Open binary spike output files
+  // **NOTE** convert to CSV for plotting with common/spike_binary_to_csv.py
+  SpikeBinaryRecorder spikes("spikes.bin", glbSpkCntE, glbSpkE);
 
   auto simStart = chrono::steady_clock::now();
   // Loop through timesteps
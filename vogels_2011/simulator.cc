@@ -3,7 +3,7 @@
 #include <numeric>
 #include <random>
 
-#include "../common/connectors.h"
+#include "../common/connectivity_cache.h"
 #include "../common/spike_csv_recorder.h"
 
 #include "vogels_2011_CODE/definitions.h"
@@ -18,17 +18,17 @@ int main()
   auto  initStart = chrono::steady_clock::now(); 
   initialize();
 
-  std::random_device rd;
-  std::mt19937 gen(rd());
-
-  buildFixedProbabilityConnector(500, 500, 0.02f,
-                                 CII, &allocateII, gen);
-  buildFixedProbabilityConnector(500, 2000, 0.02f,
-                                 CIE, &allocateIE, gen);
-  buildFixedProbabilityConnector(2000, 2000, 0.02f,
-                                 CEE, &allocateEE, gen);
-  buildFixedProbabilityConnector(2000, 500, 0.02f,
-                                 CEI, &allocateEI, gen);
+  // Build connectivity using a different seed for each projection
+  // **NOTE** fixed, along with initial voltages, so runs are reproducible
+  const unsigned int seed = 1234;
+  buildFixedProbabilityConnectorCached(500, 500, 0.02f,
+                                       CII, &allocateII, seed);
+  buildFixedProbabilityConnectorCached(500, 2000, 0.02f,
+                                       CIE, &allocateIE, seed + 1);
+  buildFixedProbabilityConnectorCached(2000, 2000, 0.02f,
+                                       CEE, &allocateEE, seed + 2);
+  buildFixedProbabilityConnectorCached(2000, 500, 0.02f,
+                                       CEI, &allocateEI, seed + 3);
 
   // Copy conductances
   std::fill(&gIE[0], &gIE[CIE.connN], 0.0);
@@ -36,7 +36,8 @@ int main()
   // Setup reverse connection indices for STDP
   initvogels_2011();
 
-  // Randomlise initial membrane voltages
+  // Randomlise initial membrane voltages using a seed distinct from those used for connectivity
+  std::mt19937 gen(seed + 4);
   std::uniform_real_distribution<> dis(-60.0, -50.0);
   for(unsigned int i = 0; i < 2000; i++)
   {